@@ -0,0 +1,62 @@
+#include "xbench.h"
+
+#include "xdata.h"
+
+// Built twice: once linked against xdata/xdata.c, where every call below is
+// an opaque call into another unit, and once with XDATA_INLINE.
+#ifdef XDATA_INLINE
+#define MODE "_inline"
+#else
+#define MODE "_owner"
+#endif
+
+#define ROUNDS 20000000
+
+int main(int argc, char *argv[]) {
+    pixel p = { 5, 10, NULL, 0.5 };
+    volatile int start = 0;
+    unsigned long sum = 0;
+    long round;
+    int i;
+
+    // A constant argument, which only the inline mode can fold away.
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        sum += *color_str(Green);
+    }
+    xbench_report("color_str_const" MODE, color_count, ROUNDS);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        sum += color_index(color_values[round % color_count]);
+    }
+    xbench_report("color_index" MODE, color_count, ROUNDS);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        sum += color_group(color_values[round % color_count]);
+    }
+    xbench_report("color_group" MODE, color_count, ROUNDS);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        i = (start + round) % pixel_members;
+        sum += (unsigned long)pixel_member(&p, i);
+    }
+    xbench_report("pixel_member" MODE, pixel_members, ROUNDS);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        sum += pixel_index(&p, &p.alpha);
+    }
+    xbench_report("pixel_index_const" MODE, pixel_members, ROUNDS);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS / 10; round++) {
+        sum += color_from_str("Black", 5);
+    }
+    xbench_report("color_from_str" MODE, color_count, ROUNDS / 10);
+
+    xbench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,4 @@
+#define XNAME e10
+#define XGROUP 1
+#include "xenum.h"
+XBENCH_10(X, e10_, GROUP)
@@ -0,0 +1,4 @@
+#define XNAME e10k
+#define XGROUP 1
+#include "xenum.h"
+XBENCH_10000(X, e10k_, GROUP)
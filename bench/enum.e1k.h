@@ -0,0 +1,4 @@
+#define XNAME e1k
+#define XGROUP 1
+#include "xenum.h"
+XBENCH_1000(X, e1k_, GROUP)
@@ -0,0 +1,4 @@
+#define XNAME groupnames
+#define XGROUP 1
+#include "xenum.h"
+XBENCH_1000(X, group_, GROUP)
@@ -0,0 +1,3 @@
+#define XNAME names
+#include "xenum.h"
+XBENCH_1000(X, name_, XBENCH_NONE)
@@ -0,0 +1,106 @@
+#include "xbench.h"
+
+#define XDATA_OWNER
+#include "enum.groupnames.h"
+#include "../xdata/xdata.h"
+
+#define ROUNDS 20000
+
+static unsigned long total;
+
+int sum_callback(groupnames value) {
+    total += value;
+    return 0;
+}
+
+int sum_x(int *x, void *context) {
+    *(unsigned long *)context += *x;
+    return 0;
+}
+
+int sum_y(int *y, void *context) {
+    *(unsigned long *)context += *y;
+    return 0;
+}
+
+int sum_member(void *member) {
+    total += *(int *)member;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    static const pixel_visitor visitor = { .x = sum_x, .y = sum_y };
+    pixel p = { 5, 10, NULL, 0.5 };
+    groupnames value;
+    void *member;
+    int round;
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        groupnames_iter(sum_callback);
+    }
+    xbench_report("iter_callback", groupnames_identifiers,
+            (long)ROUNDS * groupnames_identifiers);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        XENUM_FOREACH(groupnames, value) {
+            total += value;
+        }
+    }
+    xbench_report("iter_foreach", groupnames_identifiers,
+            (long)ROUNDS * groupnames_identifiers);
+
+    // Both group loops inline to the same machine code: the callback is
+    // known, so group_iter() and sum_callback() are inlined, and the macro
+    // calls the same group_indices(). Any gap between them is noise and code
+    // placement. Swapping their order swaps which one looks slower.
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        groupnames_group_iter(round % 10, sum_callback);
+    }
+    xbench_report("group_iter_callback", groupnames_identifiers,
+            (long)ROUNDS * groupnames_identifiers / 10);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        XENUM_FOREACH_IN_GROUP(groupnames, value, round % 10) {
+            total += value;
+        }
+    }
+    xbench_report("group_iter_foreach", groupnames_identifiers,
+            (long)ROUNDS * groupnames_identifiers / 10);
+
+    // The struct changes every round and the sum is stored every round, so
+    // the compiler can't hoist the work out of the loop. Once inlined, visit()
+    // does nothing but the two additions.
+    xbench_start();
+    for (round = 0; round < ROUNDS * 100; round++) {
+        p.y = round;
+        pixel_group_iter(&p, pix_pos, sum_member);
+        xbench_sink = total;
+    }
+    xbench_report("pixel_group_iter_callback", pixel_members,
+            (long)ROUNDS * 100);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS * 100; round++) {
+        p.y = round;
+        pixel_visit(&p, &visitor, &total);
+        xbench_sink = total;
+    }
+    xbench_report("pixel_visit", pixel_members, (long)ROUNDS * 100);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS * 100; round++) {
+        p.y = round;
+        XSTRUCT_FOREACH_IN_GROUP(pixel, &p, member, pix_pos) {
+            total += *(int *)member;
+        }
+        xbench_sink = total;
+    }
+    xbench_report("pixel_foreach_in_group", pixel_members, (long)ROUNDS * 100);
+
+    xbench_sink = total;
+    return 0;
+}
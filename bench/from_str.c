@@ -0,0 +1,61 @@
+#include <string.h>
+
+#include "xbench.h"
+
+#define XDATA_OWNER
+#include "enum.names.h"
+
+#define ROUNDS 2000
+
+// The strcmp scan that color_from_str() replaces.
+names naive_from_str(const char *s) {
+    int i;
+    for (i = 0; i < names_count; i++) {
+        if (strcmp(XENUM_POOL(names_str, i), s) == 0) {
+            return names_values[i];
+        }
+    }
+    return names_max;
+}
+
+int main(int argc, char *argv[]) {
+    const char *queries[names_identifiers];
+    size_t lengths[names_identifiers];
+    int i, j, round;
+
+    // Look names up in a scrambled order so the naive scan isn't flattered.
+    for (i = 0; i < names_identifiers; i++) {
+        j = (i * 7919) % names_identifiers;
+        queries[i] = XENUM_POOL(names_str, j);
+        lengths[i] = strlen(queries[i]);
+    }
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < names_identifiers; i++) {
+            xbench_sink += naive_from_str(queries[i]);
+        }
+    }
+    xbench_report("from_str_naive", names_identifiers,
+            (long)ROUNDS * names_identifiers);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < names_identifiers; i++) {
+            xbench_sink += names_from_str(queries[i], lengths[i]);
+        }
+    }
+    xbench_report("from_str", names_identifiers,
+            (long)ROUNDS * names_identifiers);
+
+    xbench_start();
+    for (round = 0; round < ROUNDS; round++) {
+        for (i = 0; i < names_identifiers; i++) {
+            xbench_sink += names_from_str_nocase(queries[i], lengths[i]);
+        }
+    }
+    xbench_report("from_str_nocase", names_identifiers,
+            (long)ROUNDS * names_identifiers);
+
+    return 0;
+}
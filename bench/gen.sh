@@ -0,0 +1,46 @@
+#!/bin/sh
+# Print a synthetic enum.NAME.h or struct.NAME.h definition file.
+# Usage: bench/gen.sh enum|struct NAME SIZE [group] [value] [prefix] [list]
+#  group   adds XGROUP, with entries spread over ten groups
+#  value   adds XVALUE, with every entry given an explicit, even value
+#  prefix  adds XPREFIX (enums only)
+#  list    writes the entries into XLIST instead of after the #include
+set -e
+
+kind=$1 name=$2 size=$3
+shift 3
+group= value= prefix= list=
+for feature in "$@"; do
+    case $feature in
+        group) group=1 ;;
+        value) value=1 ;;
+        prefix) prefix=1 ;;
+        list) list=1 ;;
+        *) echo "unknown feature: $feature" >&2; exit 1 ;;
+    esac
+done
+
+echo "#define XNAME $name"
+[ -n "$group" ] && echo "#define XGROUP 1"
+[ -n "$value" ] && echo "#define XVALUE 1"
+[ -n "$prefix" ] && echo "#define XPREFIX ${name}_"
+[ -n "$list" ] && echo "#define XLIST \\"
+[ -z "$list" ] && echo "#include \"x$kind.h\""
+
+awk -v kind="$kind" -v name="$name" -v size="$size" -v group="$group" \
+        -v value="$value" -v prefix="$prefix" -v list="$list" 'BEGIN {
+    for (i = 0; i < size; i++) {
+        if (kind == "enum") {
+            line = sprintf("X(%s%d)", prefix ? "id" : name "_", i)
+        } else {
+            line = sprintf("X(int, m%d)", i)
+        }
+        if (value) line = line sprintf(" VALUE(=%d)", i * 2)
+        if (group) line = line sprintf(" GROUP(%d)", i % 10)
+        print (list ? "    " line " \\" : line)
+    }
+    if (list) print ""
+}'
+
+[ -n "$list" ] && echo "#include \"x$kind.h\""
+exit 0
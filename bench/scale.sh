@@ -0,0 +1,65 @@
+#!/bin/sh
+# Measure how preprocessing time, compile time and object size grow with the
+# size of a definition, for each option and with and without XLIST. Prints one
+# tab-separated line per configuration.
+# Usage: bench/scale.sh
+#  ENUM_SIZES, STRUCT_SIZES  entry counts to try
+#  CC, CFLAGS                compiler and flags to measure
+set -e
+
+cd "$(dirname "$0")/.."
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+ENUM_SIZES=${ENUM_SIZES:-1000 10000 30000}
+STRUCT_SIZES=${STRUCT_SIZES:-100 300}
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+now() {
+    date +%s%N
+}
+
+# Time the preprocessor and compiler on one generated definition, and report
+# the sizes of the resulting object's sections.
+measure() {
+    kind=$1 size=$2 features=$3 mode=$4
+    bench/gen.sh "$kind" gen "$size" $features $mode > "$dir/$kind.gen.h"
+    {
+        echo "#define XDATA_OWNER"
+        # xstruct.h relies on xenum.h's internals, so give structs the
+        # smallest enum there is.
+        [ "$kind" = struct ] && echo '#include "enum.pixelgroup.h"'
+        echo "#include \"$kind.gen.h\""
+    } > "$dir/gen.c"
+
+    start=$(now)
+    $CC -E $CFLAGS -Ixdata -I"$dir" "$dir/gen.c" > /dev/null
+    preprocess=$(( ($(now) - start) / 1000000 ))
+    start=$(now)
+    $CC -c $CFLAGS -Ixdata -I"$dir" -o "$dir/gen.o" "$dir/gen.c"
+    compile=$(( ($(now) - start) / 1000000 ))
+
+    relocs=$(readelf -r "$dir/gen.o" | grep -c "^[0-9a-f]\{12\}")
+    size -A "$dir/gen.o" | awk -v relocs="$relocs" \
+            -v prefix="$kind\t$size\t${features:-none}\t${mode:-file}\t$preprocess\t$compile" '
+        $1 == ".text" { text += $2 }
+        $1 ~ /^\.(data|rodata)/ { data += $2 }
+        $1 == ".bss" { bss += $2 }
+        END { printf "%s\t%d\t%d\t%d\t%d\n", prefix, text, data, bss, relocs }'
+}
+
+printf "kind\tsize\tfeatures\tmode\tpreprocess_ms\tcompile_ms\ttext\tdata\tbss\trelocs\n"
+for size in $ENUM_SIZES; do
+    for features in "" group value prefix "group value prefix"; do
+        for mode in "" list; do
+            measure enum "$size" "$features" "$mode"
+        done
+    done
+done
+for size in $STRUCT_SIZES; do
+    for features in "" group; do
+        for mode in "" list; do
+            measure struct "$size" "$features" "$mode"
+        done
+    done
+done
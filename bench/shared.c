@@ -0,0 +1,104 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "xbench.h"
+
+#define XDATA_OWNER
+#include "xdata.h"
+
+#define ROUNDS 2000000
+#define READERS 3
+
+// One writer stores ROUNDS values while READERS threads load as fast as they
+// can, once through a mutex around a plain pixel and once through
+// pixel_shared. The writer starts once every reader is running. Reports the
+// writer's time per store and the readers' time per load, from each reader's
+// own loop, followed by the number of loads to stderr. A run where no loads
+// overlapped the stores is flagged rather than reported as a time.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pixel locked;
+static pixel_shared shared;
+static atomic_int ready;
+static atomic_int stop;
+static atomic_long loads;
+static atomic_long load_ns;
+static atomic_ulong sum;
+static int use_shared;
+
+void *reader(void *arg) {
+    pixel p;
+    unsigned long local_sum = 0;
+    long n = 0;
+    double start;
+    (void)arg;
+    atomic_fetch_add(&ready, 1);
+    start = xbench_now();
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        if (use_shared) {
+            pixel_shared_load(&shared, &p);
+        } else {
+            pthread_mutex_lock(&lock);
+            p = locked;
+            pthread_mutex_unlock(&lock);
+        }
+        local_sum += p.x;
+        n++;
+    }
+    atomic_fetch_add(&load_ns, (long)(xbench_now() - start));
+    atomic_fetch_add(&loads, n);
+    atomic_fetch_add(&sum, local_sum);
+    return NULL;
+}
+
+void run(const char *store_name, const char *load_name) {
+    pthread_t readers[READERS];
+    pixel p = { 0, 0, NULL, 0.5 };
+    long n;
+    int i;
+
+    atomic_store(&ready, 0);
+    atomic_store(&stop, 0);
+    atomic_store(&loads, 0);
+    atomic_store(&load_ns, 0);
+    for (i = 0; i < READERS; i++) {
+        pthread_create(&readers[i], NULL, reader, NULL);
+    }
+    while (atomic_load(&ready) < READERS) {
+        sched_yield();
+    }
+    xbench_start();
+    for (i = 0; i < ROUNDS; i++) {
+        p.x = i;
+        if (use_shared) {
+            pixel_shared_store(&shared, &p);
+        } else {
+            pthread_mutex_lock(&lock);
+            locked = p;
+            pthread_mutex_unlock(&lock);
+        }
+    }
+    xbench_report(store_name, pixel_members, ROUNDS);
+    atomic_store(&stop, 1);
+    for (i = 0; i < READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    n = atomic_load(&loads);
+    if (n > 0) {
+        printf("%s\t%d\t%.2f\t%.2f\n", load_name, pixel_members,
+                (double)atomic_load(&load_ns) / n, 0.0);
+        fprintf(stderr, "%s: %ld loads by %d readers\n", load_name, n, READERS);
+    } else {
+        fprintf(stderr, "%s: no loads overlapped the stores, so there's no time\n",
+                load_name);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    use_shared = 0;
+    run("shared_store_mutex", "shared_load_mutex");
+    use_shared = 1;
+    run("shared_store_seqlock", "shared_load_seqlock");
+    xbench_sink = atomic_load(&sum);
+    return 0;
+}
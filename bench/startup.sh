@@ -0,0 +1,66 @@
+#!/bin/sh
+# Measure what the string tables cost a position independent executable at
+# startup: the old array of pointers to names needs one dynamic relocation per
+# name, while the string pool and its offsets need none. Builds a generated
+# enum as it is now, and again with an array of pointers to the same names,
+# then prints one tab-separated line per layout.
+# Usage: bench/startup.sh
+#  SIZE       number of names in the generated enum
+#  RUNS       number of times each program is started
+#  CC, CFLAGS compiler and flags to measure
+set -e
+
+cd "$(dirname "$0")/.."
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+SIZE=${SIZE:-30000}
+RUNS=${RUNS:-500}
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+now() {
+    date +%s%N
+}
+
+bench/gen.sh enum gen "$SIZE" > "$dir/enum.gen.h"
+
+# The pointer layout is what gen_strs used to be.
+awk -v size="$SIZE" 'BEGIN {
+    print "const char *const gen_ptrs[] = {"
+    for (i = 0; i < size; i++) printf "    \"gen_%d\",\n", i
+    print "};"
+}' > "$dir/ptrs.h"
+
+# Start the program, touch one name so the table can't be dropped, and exit.
+build() {
+    layout=$1
+    {
+        echo "#define XDATA_OWNER"
+        echo "#include \"enum.gen.h\""
+        if [ "$layout" = pointers ]; then
+            echo "#include \"ptrs.h\""
+            echo "int main(int argc, char *argv[]) { return gen_ptrs[argc][0] == 0; }"
+        else
+            echo "int main(int argc, char *argv[]) { return gen_str(argc)[0] == 0; }"
+        fi
+    } > "$dir/$layout.c"
+    $CC $CFLAGS -fPIE -pie -Ixdata -I"$dir" -o "$dir/$layout" "$dir/$layout.c"
+}
+
+measure() {
+    layout=$1
+    build "$layout"
+    relocs=$(readelf -r "$dir/$layout" | grep -c "^[0-9a-f]\{12\}")
+    start=$(now)
+    i=0
+    while [ $i -lt "$RUNS" ]; do
+        "$dir/$layout"
+        i=$((i + 1))
+    done
+    us=$(( ($(now) - start) / 1000 / RUNS ))
+    printf "%s\t%d\t%d\t%d\n" "$layout" "$SIZE" "$relocs" "$us"
+}
+
+printf "layout\tsize\trelocs\tus_per_start\n"
+measure pool
+measure pointers
@@ -0,0 +1,4 @@
+#define XNAME s10
+#define XGROUP 1
+#include "xstruct.h"
+XBENCH_10(XBENCH_INT, f_, GROUP)
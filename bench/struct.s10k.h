@@ -0,0 +1,4 @@
+#define XNAME s10k
+#define XGROUP 1
+#include "xstruct.h"
+XBENCH_10000(XBENCH_INT, f_, GROUP)
@@ -0,0 +1,4 @@
+#define XNAME s1k
+#define XGROUP 1
+#include "xstruct.h"
+XBENCH_1000(XBENCH_INT, f_, GROUP)
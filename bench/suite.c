@@ -0,0 +1,411 @@
+#include "xbench.h"
+
+#define XDATA_OWNER
+#include "xdata.h"
+
+// The 10k member struct is built on its own, with XBENCH_S10K, since its code
+// per member takes minutes to compile. The Makefile builds it at -O1.
+#ifdef XBENCH_S10K
+#include "struct.s10k.h"
+#else
+#include "enum.e10.h"
+#include "enum.e1k.h"
+#include "enum.e10k.h"
+#include "struct.s10.h"
+#include "struct.s1k.h"
+#endif
+
+// Roughly how many entries each benchmark touches, whatever the size.
+#define WORK 2000000
+
+// How many distinct keys the struct map benchmarks use, which the gather and
+// scatter benchmarks reuse as their array. Each key differs from the others
+// in its first member, which must be an int.
+#define KEYS 1024
+
+// Benchmark every generated enum function. Lookups are reported per value,
+// iteration per call. The enum must have groups; group 0 is iterated. Validity
+// checks use every other value from the lowest, so about half are invalid.
+#define BENCH_ENUM(type, group)                                                 \
+int type##_bench_callback(type value) {                                         \
+    xbench_sink += value;                                                       \
+    return 0;                                                                   \
+}                                                                               \
+                                                                                \
+void type##_bench(void) {                                                       \
+    long rounds = WORK / type##_count, round;                                   \
+    static unsigned int indices[type##_identifiers];                            \
+    static const char *strs[type##_identifiers];                                \
+    static int groups[type##_identifiers];                                      \
+    type##_map map;                                                             \
+    int i;                                                                      \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_count; i++) {                                    \
+            xbench_sink += type##_index(type##_values[i]);                      \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_index", type##_count, rounds * type##_count);         \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_count; i++) {                                    \
+            xbench_sink += *type##_str(type##_values[i]);                       \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_str", type##_count, rounds * type##_count);           \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_count; i++) {                                    \
+            xbench_sink += type##_is_valid((type)(type##_lowest + i * 2));      \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_is_valid", type##_count, rounds * type##_count);      \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_count; i++) {                                    \
+            xbench_sink += type##_group(type##_values[i]);                      \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_group", type##_count, rounds * type##_count);         \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_iter(type##_bench_callback);                                     \
+    }                                                                           \
+    xbench_report(#type "_iter", type##_count, rounds);                         \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_group_iter(group, type##_bench_callback);                        \
+    }                                                                           \
+    xbench_report(#type "_group_iter", type##_count, rounds);                   \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_index_batch(type##_values, type##_count, indices);\
+    }                                                                           \
+    xbench_report(#type "_index_batch", type##_count, rounds * type##_count);   \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_str_batch(type##_values, type##_count, strs);     \
+    }                                                                           \
+    xbench_report(#type "_str_batch", type##_count, rounds * type##_count);     \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_group_batch(type##_values, type##_count, groups); \
+    }                                                                           \
+    xbench_report(#type "_group_batch", type##_count, rounds * type##_count);   \
+                                                                                \
+    type##_map_init(&map, sizeof(long));                                        \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_count; i++) {                                    \
+            *(long *)type##_map_put(&map, type##_values[i]) += 1;               \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_map_put", type##_count, rounds * type##_count);       \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_count; i++) {                                    \
+            xbench_sink += *(long *)type##_map_get(&map, type##_values[i]);     \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_map_get", type##_count, rounds * type##_count);       \
+    type##_map_free(&map);                                                      \
+}
+
+// Benchmark every generated struct function, like BENCH_ENUM. Printing and
+// maps are much slower than the rest, so they get fewer rounds. The raw dump,
+// a schema plus a copy of the array, is the alternative to printing each one.
+#define BENCH_STRUCT(type, group)                                               \
+int type##_bench_callback(void *member) {                                       \
+    xbench_sink += (unsigned long)member;                                       \
+    return 0;                                                                   \
+}                                                                               \
+                                                                                \
+void type##_bench(void) {                                                       \
+    static type structure, other, keys[KEYS];                                   \
+    static unsigned char packed[KEYS * sizeof(type)];                           \
+    static type##_shared shared;                                                \
+    static char json[1 << 21];                                                  \
+    type##_map map;                                                             \
+    type##_mask mask;                                                           \
+    unsigned char delta[type##_delta_max];                                      \
+    xstruct_arena *arena = xstruct_arena_local();                               \
+    xstruct_allocator allocator = xstruct_arena_allocator(arena);               \
+    long rounds = WORK / type##_members, round;                                 \
+    void *members[type##_members];                                              \
+    char *str;                                                                  \
+    int i;                                                                      \
+                                                                                \
+    for (i = 0; i < type##_members; i++) {                                      \
+        members[i] = (char *)&structure + type##_offsets[i];                    \
+    }                                                                           \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_members; i++) {                                  \
+            xbench_sink += type##_index(&structure, members[i]);                \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_index", type##_members, rounds * type##_members);     \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_members; i++) {                                  \
+            xbench_sink += (unsigned long)type##_member(&structure, i);         \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_member", type##_members, rounds * type##_members);    \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_members; i++) {                                  \
+            xbench_sink += *type##_str(&structure, members[i]);                 \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_str", type##_members, rounds * type##_members);       \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_members; i++) {                                  \
+            xbench_sink += type##_group(&structure, members[i]);                \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_group", type##_members, rounds * type##_members);     \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_iter(&structure, type##_bench_callback);                         \
+    }                                                                           \
+    xbench_report(#type "_iter", type##_members, rounds);                       \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_group_iter(&structure, group, type##_bench_callback);            \
+    }                                                                           \
+    xbench_report(#type "_group_iter", type##_members, rounds);                 \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_hash(&structure);                                 \
+    }                                                                           \
+    xbench_report(#type "_hash", type##_members, rounds);                       \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_equal(&structure, &other);                        \
+    }                                                                           \
+    xbench_report(#type "_equal", type##_members, rounds);                      \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_cmp(&structure, &other);                          \
+    }                                                                           \
+    xbench_report(#type "_cmp", type##_members, rounds);                        \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_hash_group(&structure, group);                    \
+    }                                                                           \
+    xbench_report(#type "_hash_group", type##_members, rounds);                 \
+                                                                                \
+    *(int *)type##_member(&other, 0) = 1;                                       \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_diff(&structure, &other, &mask);                  \
+    }                                                                           \
+    xbench_report(#type "_diff", type##_members, rounds);                       \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_delta_encode(&structure, &other, delta);          \
+    }                                                                           \
+    xbench_report(#type "_delta_encode", type##_members, rounds);               \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_delta_apply(&structure, delta);                   \
+    }                                                                           \
+    xbench_report(#type "_delta_apply", type##_members, rounds);                \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_shared_store(&shared, &structure);                               \
+    }                                                                           \
+    xbench_report(#type "_shared_store", type##_members, rounds);               \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_shared_load(&shared, &other);                                    \
+        xbench_sink += *(int *)type##_member(&other, 0);                        \
+    }                                                                           \
+    xbench_report(#type "_shared_load", type##_members, rounds);                \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        type##_shared_load_group(&shared, &other, group);                       \
+        xbench_sink += *(int *)type##_member(&other, 0);                        \
+    }                                                                           \
+    xbench_report(#type "_shared_load_group", type##_members, rounds);          \
+    structure = other;                                                          \
+                                                                                \
+    rounds = rounds / 20 + 1;                                                   \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < type##_members; i++) {                                  \
+            str = type##_print_member(&structure, members[i], "%%s = %%%s");    \
+            xbench_sink += *str;                                                \
+            free(str);                                                          \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_print_member", type##_members,                        \
+            rounds * type##_members);                                           \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        str = type##_print(&structure, "%%s = %%%s", "; ");                     \
+        xbench_sink += *str;                                                    \
+        free(str);                                                              \
+    }                                                                           \
+    xbench_report(#type "_print", type##_members, rounds);                      \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        str = type##_print_with(&structure, "%%s = %%%s", "; ", &allocator);    \
+        xbench_sink += *str;                                                    \
+        xstruct_arena_reset(arena);                                             \
+    }                                                                           \
+    xbench_report(#type "_print_arena", type##_members, rounds);                \
+                                                                                \
+    type##_map_init(&map, sizeof(long));                                        \
+    for (i = 0; i < KEYS; i++) {                                                \
+        keys[i] = structure;                                                    \
+        *(int *)type##_member(&keys[i], 0) = i;                                 \
+    }                                                                           \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < KEYS; i++) {                                            \
+            *(long *)type##_map_put(&map, &keys[i]) += 1;                       \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_map_put", type##_members, rounds * KEYS);             \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < KEYS; i++) {                                            \
+            xbench_sink += *(long *)type##_map_get(&map, &keys[i]);             \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_map_get", type##_members, rounds * KEYS);             \
+    type##_map_free(&map);                                                      \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        for (i = 0; i < KEYS; i++) {                                            \
+            type##_group_copy(&keys[i], &other, group);                         \
+        }                                                                       \
+    }                                                                           \
+    xbench_report(#type "_group_copy", type##_members, rounds * KEYS);          \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_group_gather(keys, KEYS, group, packed);          \
+    }                                                                           \
+    xbench_report(#type "_group_gather", type##_members, rounds * KEYS);        \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += type##_group_scatter(keys, KEYS, group, packed);         \
+    }                                                                           \
+    xbench_report(#type "_group_scatter", type##_members, rounds * KEYS);       \
+                                                                                \
+    xbench_start();                                                             \
+    for (round = 0; round < rounds; round++) {                                  \
+        xbench_sink += xstruct_schema_json(type##_schema(), json, sizeof(json));\
+        memcpy(packed, keys, sizeof(keys));                                     \
+    }                                                                           \
+    xbench_report(#type "_dump_raw", type##_members, rounds * KEYS);            \
+}
+
+// Benchmark the flag enum functions on every mask of permission's flags.
+int permission_bench_callback(permission value) {
+    xbench_sink += value;
+    return 0;
+}
+
+void permission_bench(void) {
+    long rounds = WORK / (permission_all + 1), round;
+    char strs[permission_all + 1][32];
+    unsigned int mask, parsed;
+
+    xbench_start();
+    for (round = 0; round < rounds; round++) {
+        for (mask = 0; mask <= permission_all; mask++) {
+            permission_mask_iter(mask, permission_bench_callback);
+        }
+    }
+    xbench_report("permission_mask_iter", permission_count,
+            rounds * (permission_all + 1));
+
+    xbench_start();
+    for (round = 0; round < rounds; round++) {
+        for (mask = 0; mask <= permission_all; mask++) {
+            xbench_sink += permission_mask_str(mask, strs[mask], sizeof(strs[mask]));
+        }
+    }
+    xbench_report("permission_mask_str", permission_count,
+            rounds * (permission_all + 1));
+
+    xbench_start();
+    for (round = 0; round < rounds; round++) {
+        for (mask = 0; mask <= permission_all; mask++) {
+            permission_mask_from_str(strs[mask], strlen(strs[mask]), &parsed);
+            xbench_sink += parsed;
+        }
+    }
+    xbench_report("permission_mask_from_str", permission_count,
+            rounds * (permission_all + 1));
+}
+
+#ifdef XBENCH_S10K
+
+BENCH_STRUCT(s10k, 0)
+
+int main(int argc, char *argv[]) {
+    s10k_bench();
+    xstruct_arena_free(xstruct_arena_local());
+    return 0;
+}
+
+#else
+
+BENCH_ENUM(color, Color)
+BENCH_ENUM(e10, 0)
+BENCH_ENUM(e1k, 0)
+BENCH_ENUM(e10k, 0)
+BENCH_STRUCT(pixel, pix_pos)
+BENCH_STRUCT(s10, 0)
+BENCH_STRUCT(s1k, 0)
+
+int main(int argc, char *argv[]) {
+    color_bench();
+    e10_bench();
+    e1k_bench();
+    e10k_bench();
+    permission_bench();
+    pixel_bench();
+    s10_bench();
+    s1k_bench();
+    xstruct_arena_free(xstruct_arena_local());
+    return 0;
+}
+
+#endif // XBENCH_S10K
@@ -0,0 +1,94 @@
+#ifndef XBENCH_H_
+#define XBENCH_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Generate synthetic X() lists by pasting digits onto a prefix. The item
+// argument names the macro that emits each entry, and the group argument
+// names a macro that's passed the entry's last digit. Passing names rather
+// than X() or GROUP() calls keeps them from expanding early.
+// Example:
+//  XBENCH_10(X, id_, XBENCH_NONE)  // X(id_0) X(id_1) ... X(id_9)
+//  XBENCH_10(X, id_, GROUP)        // X(id_0) GROUP(0) X(id_1) GROUP(1) ...
+//  XBENCH_10(XBENCH_INT, id_, XBENCH_NONE) // X(int, id_0) X(int, id_1) ...
+#define XBENCH_10(item, p, group)                                               \
+    item(p##0) group(0) item(p##1) group(1) item(p##2) group(2)                 \
+    item(p##3) group(3) item(p##4) group(4) item(p##5) group(5)                 \
+    item(p##6) group(6) item(p##7) group(7) item(p##8) group(8)                 \
+    item(p##9) group(9)
+#define XBENCH_100(item, p, group)                                              \
+    XBENCH_10(item, p##0, group) XBENCH_10(item, p##1, group)                   \
+    XBENCH_10(item, p##2, group) XBENCH_10(item, p##3, group)                   \
+    XBENCH_10(item, p##4, group) XBENCH_10(item, p##5, group)                   \
+    XBENCH_10(item, p##6, group) XBENCH_10(item, p##7, group)                   \
+    XBENCH_10(item, p##8, group) XBENCH_10(item, p##9, group)
+#define XBENCH_1000(item, p, group)                                             \
+    XBENCH_100(item, p##0, group) XBENCH_100(item, p##1, group)                 \
+    XBENCH_100(item, p##2, group) XBENCH_100(item, p##3, group)                 \
+    XBENCH_100(item, p##4, group) XBENCH_100(item, p##5, group)                 \
+    XBENCH_100(item, p##6, group) XBENCH_100(item, p##7, group)                 \
+    XBENCH_100(item, p##8, group) XBENCH_100(item, p##9, group)
+#define XBENCH_10000(item, p, group)                                            \
+    XBENCH_1000(item, p##0, group) XBENCH_1000(item, p##1, group)               \
+    XBENCH_1000(item, p##2, group) XBENCH_1000(item, p##3, group)               \
+    XBENCH_1000(item, p##4, group) XBENCH_1000(item, p##5, group)               \
+    XBENCH_1000(item, p##6, group) XBENCH_1000(item, p##7, group)               \
+    XBENCH_1000(item, p##8, group) XBENCH_1000(item, p##9, group)
+
+#define XBENCH_NONE(g)
+#define XBENCH_INT(identifier) X(int, identifier)
+
+// Results are written to this so the compiler can't discard the work.
+static volatile unsigned long xbench_sink;
+
+// Allocations made so far. Counted by the --wrap wrappers below, which the
+// Makefile links every benchmark with.
+static unsigned long xbench_allocs;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    xbench_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    xbench_allocs++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    xbench_allocs++;
+    return __real_realloc(ptr, size);
+}
+
+// Get the current time in nanoseconds.
+static double xbench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Time and allocation count at the last xbench_start().
+static double xbench_start_ns;
+static unsigned long xbench_start_allocs;
+
+// Start timing a benchmark.
+static void xbench_start(void) {
+    xbench_start_allocs = xbench_allocs;
+    xbench_start_ns = xbench_now();
+}
+
+// Print the benchmark started by xbench_start() as a tab-separated line:
+// benchmark, size, ns/op, allocations/op.
+static void xbench_report(const char *name, int size, long ops) {
+    double ns = xbench_now() - xbench_start_ns;
+    unsigned long allocs = xbench_allocs - xbench_start_allocs;
+    printf("%s\t%d\t%.2f\t%.2f\n", name, size, ns / ops, (double)allocs / ops);
+}
+
+#endif /* XBENCH_H_ */
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "xdata/xdata.h"
 
@@ -10,6 +11,11 @@ int color_callback(color c) {
     return 0;
 }
 
+int permission_callback(permission p) {
+    printf("%s ", permission_str(p));
+    return 0;
+}
+
 int pos_callback(void *ptr) {
     printf("%d ", *(int *)ptr);
     return 0;
@@ -30,10 +36,48 @@ void ex_color_str() {
     printf("%d %s", Green, color_str(Green)); // 1 Green
 }
 
+void ex_color_from_str() {
+    printf("%d %d", color_from_str("Blue", 4), color_from_str_nocase("bLACK", 5)); // 2 11
+}
+
+void ex_color_is_valid() {
+    printf("%d %d %d", color_is_valid(White), color_is_valid(7), color_str(7) == NULL); // 1 0 1
+}
+
+void ex_color_str_batch() {
+    color values[] = { Blue, 7, Black };
+    const char *strs[3];
+    size_t invalid = color_str_batch(values, 3, strs);
+    printf("%zu %s %s", invalid, strs[0], strs[2]); // 1 Blue Black
+}
+
+void ex_color_index_batch() {
+    // More than eight values, so the first eight take the AVX2 path where the
+    // CPU has it, and the rest the scalar loop.
+    color values[] = { Red, 3, Green, Blue, -1, White, 12, Black, 9, Blue, 100, Red };
+    unsigned int indices[12];
+    size_t invalid = color_index_batch(values, 12, indices), i;
+    printf("%zu /", invalid); // 5 /
+    for (i = 0; i < 12; i++) {
+        printf(" %d", (int)indices[i]); // 0 -1 1 2 -1 3 -1 4 -1 2 -1 0
+    }
+}
+
 void ex_color_iter() {
     color_iter(color_callback); // 0 1 2 10 11
 }
     
+void ex_color_foreach() {
+    color c;
+    XENUM_FOREACH(color, c) {
+        printf("%d ", c); // 0 1 2 10 11
+    }
+    printf("/ "); // /
+    XENUM_FOREACH_IN_GROUP(color, c, Grayscale) {
+        printf("%d ", c); // 10 11
+    }
+}
+
 void ex_color_group() {
     printf("%d %s", Black, colorgroup_str(color_group(Black))); // 11 Grayscale
 }
@@ -44,6 +88,32 @@ void ex_color_group_iter() {
     color_group_iter(Grayscale, color_callback); // 10 11
 }
 
+void ex_color_map() {
+    color_map counts;
+    color_map_init(&counts, sizeof(int));
+    *(int *)color_map_put(&counts, Blue) += 2;
+    *(int *)color_map_put(&counts, Blue) += 1;
+    printf("%d %d", counts.length, *(int *)color_map_get(&counts, Blue)); // 1 3
+    color_map_free(&counts);
+}
+
+void ex_permission_mask_iter() {
+    permission_mask_iter(Read | Execute, permission_callback); // Read Execute
+}
+
+void ex_permission_mask_str() {
+    char buf[32];
+    permission_mask_str(permission_all & ~Write, buf, sizeof(buf));
+    printf("%s", buf); // Read|Execute
+}
+
+void ex_permission_mask_from_str() {
+    unsigned int mask = 0;
+    const char *str = "Write | Execute";
+    int result = permission_mask_from_str(str, strlen(str), &mask);
+    printf("%d %u", result, mask); // 0 6
+}
+
 // Example usage of xstruct.h, illustrated via struct.pixel.h and enum.pixeltype.h.
 
 void ex_pixel_index() {
@@ -85,6 +155,23 @@ void ex_pixel_print() {
     free(str);
 }
 
+void ex_pixel_print_with() {
+    pixel p = { 5, 10, Red, 0.5 };
+    xstruct_arena *arena = xstruct_arena_local();
+    xstruct_allocator allocator = xstruct_arena_allocator(arena);
+    char *x = pixel_print_member_with(&p, &p.x, "%%s=%%%s", &allocator);
+    char *y = pixel_print_member_with(&p, &p.y, "%%s=%%%s", &allocator);
+    printf("%s %s", x, y); // x=5 y=10
+    xstruct_arena_reset(arena);
+}
+
+void ex_pixel_print_to() {
+    pixel p = { 5, 10, Red, 0.5 };
+    char str[16];
+    size_t length = pixel_print_to(str, sizeof(str), &p, "%%s=%%%s", ",");
+    printf("%s... (%zu)", str, length); // x=5,y=10,color=... (??)
+}
+
 void ex_pixel_group() {
     pixel p = { 5, 10, Red, 0.5 };
     printf("in group %s", pixelgroup_str(pixel_group(&p, &p.y))); // in group pix_pos
@@ -95,15 +182,163 @@ void ex_pixel_group_iter() {
     pixel_group_iter(&p, pix_pos, pos_callback); // 5 10
 }
 
+void ex_pixel_group_gather() {
+    pixel from[2] = { { 5, 10, Red, 0.5 }, { 7, 3, Red, 0.25 } };
+    pixel to[2] = { { 0 } };
+    unsigned char pos[2 * sizeof(pixel)];
+    size_t size = pixel_group_gather(from, 2, pix_pos, pos);
+    pixel_group_scatter(to, 2, pix_pos, pos);
+    printf("%zu bytes: %d %d %f", size, to[1].x, to[1].y, to[1].alpha); // 16 bytes: 7 3 0.000000
+}
+
+void ex_pixel_soa() {
+    pixel pixels[] = { { 5, 10, Red, 0.5 }, { 6, 11, Red, 0.25 } };
+    pixel p;
+    pixel_soa soa = { 0 };
+    pixel_soa_from_array(&soa, pixels, 2);
+    pixel_soa_push(&soa, &pixels[0]);
+    pixel_soa_get(&soa, 1, &p);
+    printf("%zu: %d %d %f", soa.length, soa.x[2], p.y, soa.alpha[1]); // 3: 5 11 0.250000
+    pixel_soa_free(&soa);
+}
+
+void ex_pixel_serialize() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel q;
+    unsigned char record[sizeof(pixel_record)];
+    size_t size = pixel_serialize(&p, record);
+    pixel_deserialize(&q, record);
+    printf("%zu bytes: %d %d %f", size, q.x, q.y, q.alpha); // 20 bytes: 5 10 0.500000
+}
+
+void ex_pixel_parse() {
+    pixel p = { 0 };
+    const char *str = "y = -3; alpha = 0.25; x = 7";
+    int found = pixel_parse(str, strlen(str), "%%s = %%%s", "; ", &p);
+    printf("%d: %d %d %f", found, p.x, p.y, p.alpha); // 3: 7 -3 0.250000
+}
+
+void ex_pixel_equal() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel q = { 5, 11, Red, 0.5 };
+    printf("%d %d", pixel_equal(&p, &q), pixel_equal_group(&p, &q, pix_pos)); // 0 0
+}
+
+void ex_pixel_cmp() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel q = { 5, 11, Red, 0.25 };
+    printf("%d %d", pixel_cmp(&p, &q), pixel_cmp_group(&p, &q, pix_other)); // -1 1
+}
+
+void ex_pixel_hash() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel q = { 5, 10, Red, 0.25 };
+    printf("%d", pixel_hash_group(&p, pix_pos) == pixel_hash_group(&q, pix_pos)); // 1
+}
+
+void ex_pixel_map() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel_map counts;
+    pixel_map_init(&counts, sizeof(int));
+    *(int *)pixel_map_put(&counts, &p) += 1;
+    p.alpha = 0.25;
+    *(int *)pixel_map_put(&counts, &p) += 1;
+    printf("%zu %d", counts.length, *(int *)pixel_map_get(&counts, &p)); // 2 1
+    pixel_map_free(&counts);
+}
+
+void ex_pixel_layout() {
+    printf("%d %d %d", pixel_padding, pixel_cache_lines, pixel_reordered_size); // 4 1 24
+}
+
+void ex_pixel_pack() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel_packed packed;
+    pixel q;
+    pixel_pack(&p, &packed);
+    pixel_unpack(&packed, &q);
+    printf("%zu bytes: %d %d %f", sizeof(packed), q.x, q.y, q.alpha); // 20 bytes: 5 10 0.500000
+}
+
+void ex_pixel_delta() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel q = p;
+    pixel_mask mask;
+    unsigned char delta[pixel_delta_max];
+    size_t size;
+    int changed;
+    q.y = 11;
+    changed = pixel_diff(&p, &q, &mask);
+    printf("%d %llx ", changed, (unsigned long long)mask.words[0]); // 1 2
+    size = pixel_delta_encode(&p, &q, delta);
+    pixel_delta_apply(&p, delta);
+    printf("%zu bytes: %d", size, p.y); // 5 bytes: 11
+}
+
+void ex_pixel_schema() {
+    const xstruct_schema *schema = pixel_schema();
+    char json[512];
+    char dtype[8];
+    xstruct_dtype(&schema->fields[3], dtype, sizeof(dtype));
+    xstruct_schema_json(schema, json, sizeof(json));
+    printf("%s %s %.40s", schema->fields[3].name, dtype, json); // alpha <f4 {"name":"pixel","size":24,"align":8,"fie
+}
+
+void ex_pixel_shared() {
+    static pixel_shared shared;
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel q = { 0 };
+    pixel_shared_store(&shared, &p);
+    pixel_shared_load_group(&shared, &q, pix_pos);
+    printf("%d %d %f ", q.x, q.y, q.alpha); // 5 10 0.000000
+    pixel_shared_load(&shared, &q);
+    printf("%f", q.alpha); // 0.500000
+}
+
+int visit_y(int *y, void *context) {
+    *(int *)context += *y;
+    return 0;
+}
+
+int visit_alpha(float *alpha, void *context) {
+    *(int *)context += *alpha * 100;
+    return 0;
+}
+
+void ex_pixel_visit() {
+    pixel p = { 5, 10, Red, 0.5 };
+    pixel_visitor visitor = { .y = visit_y, .alpha = visit_alpha };
+    int total = 0;
+    pixel_visit(&p, &visitor, &total);
+    printf("%d", total); // 60
+}
+
+void ex_pixel_foreach() {
+    pixel p = { 5, 10, Red, 0.5 };
+    void *member;
+    XSTRUCT_FOREACH_IN_GROUP(pixel, &p, member, pix_pos) {
+        printf("%s ", pixel_str(&p, member)); // x y
+    }
+}
+
 // Run each example.
 
 void (*examples[])() = {
     // xenum.h
     ex_color_index,
     ex_color_str,
+    ex_color_from_str,
+    ex_color_is_valid,
+    ex_color_str_batch,
+    ex_color_index_batch,
     ex_color_iter,
+    ex_color_foreach,
     ex_color_group,
     ex_color_group_iter,
+    ex_color_map,
+    ex_permission_mask_iter,
+    ex_permission_mask_str,
+    ex_permission_mask_from_str,
     // xstruct.h
     ex_pixel_index,
     ex_pixel_member,
@@ -112,8 +347,25 @@ void (*examples[])() = {
     ex_pixel_iter,
     ex_pixel_print_member,
     ex_pixel_print,
+    ex_pixel_print_with,
+    ex_pixel_print_to,
     ex_pixel_group,
     ex_pixel_group_iter,
+    ex_pixel_group_gather,
+    ex_pixel_visit,
+    ex_pixel_foreach,
+    ex_pixel_soa,
+    ex_pixel_serialize,
+    ex_pixel_parse,
+    ex_pixel_equal,
+    ex_pixel_cmp,
+    ex_pixel_hash,
+    ex_pixel_map,
+    ex_pixel_layout,
+    ex_pixel_pack,
+    ex_pixel_delta,
+    ex_pixel_schema,
+    ex_pixel_shared,
     // sentinel
     NULL
 };
@@ -0,0 +1,6 @@
+#define XNAME permission
+#define XFLAGS 1
+#include "xenum.h"
+X(Read)
+X(Write)
+X(Execute)
@@ -1,5 +1,7 @@
 #define XNAME pixel
 #define XGROUP 1
+#define XPACKED 1
+#define XSOA 1
 #include "xstruct.h"
 X(int, x)           GROUP(pix_pos)
 X(int, y)           GROUP(pix_pos)
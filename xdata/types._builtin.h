@@ -1,44 +1,22 @@
-X(char, d)
-X(short, d)
-X(int, d)
-X(signed, d)
-X(signed char, d)
-X(signed short, d)
-X(signed int, d)
-X(int8_t, d)
-X(int16_t, d)
-X(int32_t, d)
-
-X(unsigned, u)
-X(unsigned char, u)
-X(unsigned short, u)
-X(unsigned int, u)
-X(uint8_t, u)
-X(uint16_t, u)
-X(uint32_t, u)
-
-X(long, l)
-X(long int, l)
-X(signed long, l)
-X(signed long int, l)
-
-X(unsigned long, lu)
-X(unsigned long int, lu)
-
-X(long long, ll)
-X(long long int, ll)
-X(signed long long, ll)
-X(signed long long int, ll)
-X(int64_t, ll)
-
-X(unsigned long long, llu)
-X(unsigned long long int, llu)
-X(uint64_t, ll)
-
-X(float, f)
-X(double, f)
-
-X(long double, Lf)
-
-X(char*, s)
-X(char *, s)
\ No newline at end of file
+// Built-in types, listed as T(type, format, tag). The format is the printf
+// conversion used to print the type, and the tag names it in xstruct_type.
+// Types are matched with _Generic, so each one must be distinct; typedefs
+// such as int32_t or uint8_t match the type they're defined as.
+#define XTYPES_BUILTIN(T)              \
+    T(_Bool, d, bool)                  \
+    T(char, d, char)                   \
+    T(signed char, d, schar)           \
+    T(unsigned char, u, uchar)         \
+    T(short, d, short)                 \
+    T(unsigned short, u, ushort)       \
+    T(int, d, int)                     \
+    T(unsigned int, u, uint)           \
+    T(long, ld, long)                  \
+    T(unsigned long, lu, ulong)        \
+    T(long long, lld, llong)           \
+    T(unsigned long long, llu, ullong) \
+    T(float, f, float)                 \
+    T(double, f, double)               \
+    T(long double, Lf, ldouble)        \
+    T(char *, s, str)                  \
+    T(const char *, s, cstr)
@@ -5,6 +5,7 @@
 #include "enum.colorgroup.h"
 #include "enum.pixelgroup.h"
 #include "enum.color.h"
+#include "enum.permission.h"
 #include "struct.pixel.h"
 
 #endif /* XDATA_H_ */
@@ -38,6 +38,17 @@
 #define VALUE(v)
 #endif // XVALUE
 
+// XFLAGS: give each identifier its own bit, 1 << its index, so that values
+// can be combined into masks. Allows up to 31 identifiers, and can't be used
+// with XVALUE.
+// Usage:
+//  #define XFLAGS 1
+//  X(identifier1)               // 1
+//  X(identifier2)               // 2
+#if XFLAGS && XVALUE
+#error "XFLAGS and XVALUE can't be used together"
+#endif // XFLAGS && XVALUE
+
 // XPREFIX: add a prefix before each identifier.
 // Usage:
 //  #define XPREFIX foo_
@@ -51,11 +62,26 @@
 #define XENUM_ID(identifier) identifier
 #endif // XPREFIX
 
+// XLIST: take the identifiers from the XLIST macro instead of the rest of the
+// enum.*.h file. The file is then read once rather than once per table and
+// function, which speeds up preprocessing of very large enums.
+// Usage:
+//  #define XLIST X(identifier1) X(identifier2)
+#ifdef XLIST
+#define XENUM_FILE(name) "xlist.h"
+#else // XLIST
+#define XENUM_FILE(name) XENUM_STR(enum.name.h)
+#endif // XLIST
+
 #ifndef XENUM_H_
 #define XENUM_H_
 // Everything in this block should only show up once per compilation unit.
 
 #include <ctype.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 // Internal macros.
@@ -63,11 +89,225 @@
 #define XENUM_STR(identifier) XENUM_STR_(identifier)
 #define XENUM_GLUE_(prefix, suffix) prefix ## _ ## suffix
 #define XENUM_GLUE(prefix, suffix) XENUM_GLUE_(prefix, suffix)
-#define XENUM_FILE(name) XENUM_STR(enum.name.h)
+
+// Added to each value when sizing the arrays used to find the lowest and
+// highest values at compile time, so that negative values still produce a
+// positive array size. 32-bit targets can't declare objects as large as a
+// full int range, so they only support values within +/- 2^30.
+#if SIZE_MAX > 0xFFFFFFFFu
+#define XENUM_BIAS 0x80000000LL
+#else
+#define XENUM_BIAS 0x40000000LL
+#endif
+
+// XENUM_SPARSITY: how many lookup table slots an enum may use per identifier
+// before it falls back to a binary search. Define it before including
+// xdata.h to change the tradeoff between table size and lookup speed.
+#ifndef XENUM_SPARSITY
+#define XENUM_SPARSITY 4
+#endif
+
+// XDATA_ALLOC, XDATA_FREE: the allocator behind every allocation the library
+// makes: maps, structs of arrays, arenas and the strings returned by the
+// print functions. Define them before including xdata.h, in every unit as
+// well as the XDATA_OWNER one, to replace malloc() and free() for a whole
+// build.
+#ifndef XDATA_ALLOC
+#define XDATA_ALLOC(size) malloc(size)
+#endif
+#ifndef XDATA_FREE
+#define XDATA_FREE(ptr) free(ptr)
+#endif
+
+// Rounds a positive constant up to the next power of two.
+#define XENUM_SMEAR(n, shift) ((n) | (n) >> (shift))
+#define XENUM_POW2(n) (XENUM_SMEAR(XENUM_SMEAR(XENUM_SMEAR(XENUM_SMEAR( \
+        XENUM_SMEAR((n) - 1, 1), 2), 4), 8), 16) + 1)
+
+// Count the trailing zero bits of a nonzero 64-bit word.
+#if defined(__GNUC__)
+#define XENUM_CTZ(word) __builtin_ctzll(word)
+#else
+#define XENUM_CTZ(word) xenum_ctz(word)
+static inline int xenum_ctz(uint64_t word) {
+    int count = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        count++;
+    }
+    return count;
+}
+#endif
+
+// Loop over every value of an enum, in order, without calling back through a
+// function pointer, so the body can be inlined and vectorized.
+// Usage:
+//  color c;
+//  XENUM_FOREACH(color, c) { ... }
+#define XENUM_FOREACH(name, value)                                              \
+    for (unsigned int xenum_i_ = 0; xenum_i_ < XENUM_GLUE(name, identifiers) && \
+            ((value) = XENUM_GLUE(name, values)[xenum_i_], 1); xenum_i_++)
+
+// Loop over the values in a group, in order. Requires XGROUP. The outer two
+// loops run once, to declare the count and the read-only group indices in
+// their own scopes; break and continue apply to the innermost one.
+// Usage:
+//  color c;
+//  XENUM_FOREACH_IN_GROUP(color, c, Grayscale) { ... }
+#define XENUM_FOREACH_IN_GROUP(name, value, group)                              \
+    for (unsigned int xenum_n_, xenum_once_ = 1; xenum_once_; xenum_once_ = 0)  \
+    for (const unsigned int *xenum_g_ =                                         \
+            XENUM_GLUE(name, group_indices)(group, &xenum_n_);                  \
+            xenum_once_; xenum_once_ = 0)                                       \
+    for (unsigned int xenum_i_ = 0; xenum_i_ < xenum_n_ &&                      \
+            ((value) = XENUM_GLUE(name, values)[xenum_g_[xenum_i_]], 1); xenum_i_++)
+
+// XENUM_SIMD: whether the batch functions may use AVX2 on x86 CPUs that
+// support it, which is checked at run time. Define it as 0 before including
+// xdata.h to always use the scalar loops.
+#ifndef XENUM_SIMD
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XENUM_SIMD 1
+#else
+#define XENUM_SIMD 0
+#endif
+#endif // XENUM_SIMD
+
+// Get the Nth name from a string pool and its offsets, like color_str_pool.
+#define XENUM_POOL(name, i) \
+    (XENUM_GLUE(name, pool) + XENUM_GLUE(name, offsets)[i])
+
+// How many values the group and string batch functions convert to indices at
+// a time, on the stack, before looking up their groups or names.
+#define XENUM_BATCH 256
+
+// XDATA_INLINE: define every table and function as static data and static
+// inline functions in each compilation unit that includes xdata.h, instead of
+// only in the one that defines XDATA_OWNER. Calls like color_str(Green) can
+// then be inlined and constant-folded anywhere, at the cost of code size and
+// of each unit building its own lookup tables on first use.
+#ifdef XDATA_INLINE
+#ifndef XDATA_OWNER
+#define XDATA_OWNER
+#endif
+#define XDATA_EXTERN static
+#define XDATA_STATIC static
+#define XDATA_FUNC static inline
+#else // XDATA_INLINE
+#define XDATA_EXTERN extern
+#define XDATA_STATIC
+#define XDATA_FUNC
+#endif // XDATA_INLINE
+
+XDATA_FUNC void xenum_once(atomic_int *state, void init(void));
+XDATA_FUNC unsigned int xenum_hash(const char *s, size_t len);
+XDATA_FUNC int xenum_equal(const char *a, const char *b, size_t len, int nocase);
+XDATA_FUNC size_t xenum_lookup_batch(const int *values, size_t n, const unsigned int *lookup,
+        unsigned int lookups, int lowest, unsigned int *out);
 
 #ifdef XDATA_OWNER
 // Everything in this block should only show up in a single compilation unit.
-// There are no internal functions or variables here yet.
+
+// Calls init() the first time it's called with the given state, which must
+// start out as zero. Threads that arrive during initialization wait for it to
+// finish, so every caller sees the initialized data on return.
+XDATA_FUNC void xenum_once(atomic_int *state, void init(void)) {
+    int expected = 0;
+    if (atomic_load_explicit(state, memory_order_acquire) == 2) {
+        return;
+    }
+    if (atomic_compare_exchange_strong(state, &expected, 1)) {
+        init();
+        atomic_store_explicit(state, 2, memory_order_release);
+        return;
+    }
+    while (atomic_load_explicit(state, memory_order_acquire) != 2) {
+    }
+}
+
+// Case-insensitive FNV-1a hash of an identifier. Folding case here lets the
+// case-sensitive and case-insensitive lookups share a single table.
+XDATA_FUNC unsigned int xenum_hash(const char *s, size_t len) {
+    unsigned int hash = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        unsigned char c = s[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+// Compare two strings of the same length, optionally ignoring ASCII case.
+XDATA_FUNC int xenum_equal(const char *a, const char *b, size_t len, int nocase) {
+    size_t i;
+    if (!nocase) {
+        return memcmp(a, b, len) == 0;
+    }
+    for (i = 0; i < len; i++) {
+        unsigned char ca = a[i], cb = b[i];
+        if (ca != cb && tolower(ca) != tolower(cb)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Convert values to indices through a dense enum's lookup table, writing -1
+// for values outside it or in its gaps. Returns how many values were invalid.
+static size_t xenum_lookup_batch_scalar(const int *values, size_t n, const unsigned int *lookup,
+        unsigned int lookups, int lowest, unsigned int *out) {
+    size_t invalid = 0, i;
+    for (i = 0; i < n; i++) {
+        unsigned int offset = (unsigned int)values[i] - (unsigned int)lowest;
+        out[i] = offset < lookups ? lookup[offset] - 1 : (unsigned int)-1;
+        invalid += out[i] == (unsigned int)-1;
+    }
+    return invalid;
+}
+
+#if XENUM_SIMD
+// Only the unit defining the batch functions needs the intrinsics, which are a
+// lot of header to parse everywhere else.
+#include <immintrin.h>
+
+// Same as above, eight values at a time. Out of range lanes are masked off
+// the gather and come back as zero, which becomes -1 like an unused slot.
+__attribute__((target("avx2")))
+static size_t xenum_lookup_batch_avx2(const int *values, size_t n, const unsigned int *lookup,
+        unsigned int lookups, int lowest, unsigned int *out) {
+    const __m256i low = _mm256_set1_epi32(lowest);
+    const __m256i last = _mm256_set1_epi32((int)lookups - 1);
+    const __m256i ones = _mm256_set1_epi32(-1);
+    size_t invalid = 0, i;
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256i offset = _mm256_sub_epi32(
+                _mm256_loadu_si256((const __m256i *)(values + i)), low);
+        __m256i in_range = _mm256_cmpeq_epi32(_mm256_min_epu32(offset, last), offset);
+        __m256i index = _mm256_add_epi32(_mm256_mask_i32gather_epi32(
+                _mm256_setzero_si256(), (const int *)lookup, offset, in_range, 4), ones);
+        _mm256_storeu_si256((__m256i *)(out + i), index);
+        invalid += __builtin_popcount(_mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, ones))));
+    }
+    return invalid + xenum_lookup_batch_scalar(values + i, n - i, lookup, lookups,
+            lowest, out + i);
+}
+#endif // XENUM_SIMD
+
+// Pick the fastest of the above for this CPU.
+XDATA_FUNC size_t xenum_lookup_batch(const int *values, size_t n, const unsigned int *lookup,
+        unsigned int lookups, int lowest, unsigned int *out) {
+#if XENUM_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        return xenum_lookup_batch_avx2(values, n, lookup, lookups, lowest, out);
+    }
+#endif // XENUM_SIMD
+    return xenum_lookup_batch_scalar(values, n, lookup, lookups, lowest, out);
+}
+
 #endif // XDATA_OWNER
 
 #endif // XENUM_H_
@@ -78,9 +318,21 @@
 
 ////////// Static data structure declarations.
 
+// Create an enum holding the index of each identifier, followed by the number
+// of identifiers. This lets the lookup tables below be built at compile time.
+// Example:
+//  enum { color_index_Red, color_index_Green, ..., color_identifiers };
+#define X(identifier) XENUM_GLUE(XENUM_GLUE(XNAME, index), XENUM_ID(identifier)),
+enum {
+    #include XENUM_FILE(XNAME)
+    XENUM_GLUE(XNAME, identifiers)
+};
+#undef X
+
 // Create the enum itself.
 // Example:
 //  typedef enum { Red, Green, Blue, White=10, Black, color_max } color;
+//  typedef enum { Read = 1, Write = 2, Execute = 4, permission_max = 8 } permission;
 #if XVALUE
 // Constructor for enums with explicit values.
 #define X(identifier) XENUM_ID(identifier)
@@ -93,6 +345,20 @@ typedef enum {
 #undef VALUE
 #define VALUE(v)
 #undef X
+#elif XFLAGS
+// Constructor for flag enums. The "max" identifier is the next flag up, which
+// isn't part of any mask of the enum's flags, so from_str() can't return a
+// valid mask by mistake. With 31 flags it wraps to the sign bit, which isn't
+// either.
+_Static_assert(XENUM_GLUE(XNAME, identifiers) <= 31,
+        "flag enums can't have more than 31 identifiers");
+#define X(identifier) XENUM_ID(identifier) = \
+        1 << XENUM_GLUE(XENUM_GLUE(XNAME, index), XENUM_ID(identifier)),
+typedef enum {
+    #include XENUM_FILE(XNAME)
+    XENUM_GLUE(XNAME, max) = (int)(1u << XENUM_GLUE(XNAME, identifiers))
+} XNAME;
+#undef X
 #else // XVALUE
 // Constructor for enums without explicit values.
 #define X(identifier) XENUM_ID(identifier),
@@ -103,54 +369,161 @@ typedef enum {
 #undef X
 #endif // XVALUE
 
+// Find the lowest and highest values at compile time. A union is as large as
+// its largest member, so declaring one char array per identifier, sized by its
+// value, makes sizeof() compute the maximum for us. These are the enum's range
+// for validating input; the "max" identifier is one past the last one instead.
+// The enum is "dense" when the lookup table spanning the two wouldn't waste
+// too much space.
+// Example:
+//  enum { color_lowest = 0, color_highest = 11, color_dense = 1, color_lookups = 12,
+//         color_hashes = 16 };
+enum {
+    #define X(identifier) char XENUM_ID(identifier)[XENUM_BIAS - (long long)XENUM_ID(identifier)];
+    XENUM_GLUE(XNAME, lowest) = (int)(XENUM_BIAS - (long long)sizeof(union {
+        #include XENUM_FILE(XNAME)
+    })),
+    #undef X
+    #define X(identifier) char XENUM_ID(identifier)[(long long)XENUM_ID(identifier) + XENUM_BIAS + 1];
+    XENUM_GLUE(XNAME, highest) = (int)((long long)sizeof(union {
+        #include XENUM_FILE(XNAME)
+    }) - XENUM_BIAS - 1),
+    #undef X
+    XENUM_GLUE(XNAME, dense) = (long long)XENUM_GLUE(XNAME, highest) -
+            XENUM_GLUE(XNAME, lowest) < (long long)XENUM_SPARSITY *
+            XENUM_GLUE(XNAME, identifiers),
+    XENUM_GLUE(XNAME, lookups) = XENUM_GLUE(XNAME, dense) ?
+            (int)((long long)XENUM_GLUE(XNAME, highest) -
+            XENUM_GLUE(XNAME, lowest) + 1) : XENUM_GLUE(XNAME, identifiers),
+    XENUM_GLUE(XNAME, hashes) = XENUM_POW2(XENUM_GLUE(XNAME, identifiers) * 2)
+};
+
+#if XGROUP
+
+// Find the lowest and highest groups at compile time, the same way. Every
+// group in between gets a slot in the group index, so groups should be dense.
+// Example:
+//  enum { color_group_lowest = 0, color_group_highest = 1, color_group_slots = 2 };
+#define X(identifier) char XENUM_ID(identifier)
+#undef GROUP
+enum {
+    #define GROUP(g) [XENUM_BIAS - (long long)(g)];
+    XENUM_GLUE(XNAME, group_lowest) = (int)(XENUM_BIAS - (long long)sizeof(union {
+        #include XENUM_FILE(XNAME)
+    })),
+    #undef GROUP
+    #define GROUP(g) [(long long)(g) + XENUM_BIAS + 1];
+    XENUM_GLUE(XNAME, group_highest) = (int)((long long)sizeof(union {
+        #include XENUM_FILE(XNAME)
+    }) - XENUM_BIAS - 1),
+    #undef GROUP
+    XENUM_GLUE(XNAME, group_slots) = XENUM_GLUE(XNAME, group_highest) -
+            XENUM_GLUE(XNAME, group_lowest) + 1
+};
+#define GROUP(g)
+#undef X
+
+#endif // XGROUP
+
+#if XFLAGS
+
+// Create a mask with every flag set.
+// Example:
+//  enum { permission_all = 7 };
+enum {
+    XENUM_GLUE(XNAME, all) = (int)((1u << XENUM_GLUE(XNAME, identifiers)) - 1)
+};
+
+#endif // XFLAGS
+
+// Create a map from each value to a value of a fixed size. There's one slot
+// per identifier, found by the value's index, so lookups never hash or probe.
+// Set it up with color_map_init().
+// Example:
+//  typedef struct color_map { unsigned char *values; size_t value_size;
+//          int length; unsigned char present[5]; } color_map;
+typedef struct XENUM_GLUE(XNAME, map) {
+    unsigned char *values;
+    size_t value_size;
+    int length;
+    unsigned char present[XENUM_GLUE(XNAME, identifiers)];
+} XENUM_GLUE(XNAME, map);
+
+// Lay out the string pool: each name with its terminator, back to back. Char
+// arrays need no alignment, so offsetof() gives each name's offset in the pool
+// at compile time. Only the type is used.
+// Example:
+//  struct color_str_layout { char Red[4]; char Green[6]; char Blue[5]; ... };
+#define X(identifier) char XENUM_ID(identifier)[sizeof(XENUM_STR(XENUM_ID(identifier)))];
+struct XENUM_GLUE(XNAME, str_layout) {
+    #include XENUM_FILE(XNAME)
+};
+#undef X
+
 ////////// Variable declarations.
 
 // Contains the number of identifiers in the enum. This can differ from the
 // "max" identifier at the end if any values are explicitly set.
 // Example:
 //  int color_count;
-int XENUM_GLUE(XNAME, count);
+XDATA_EXTERN int XENUM_GLUE(XNAME, count);
 
-#define X(identifier) 1+
 // Holds the value of each identifier in an array.
 // Example:
 //  color color_values[5];
-XNAME XENUM_GLUE(XNAME, values)[
-    #include XENUM_FILE(XNAME)
-    0];
+XDATA_EXTERN XNAME XENUM_GLUE(XNAME, values)[XENUM_GLUE(XNAME, identifiers)];
 
-// Holds the string name of each identifier in an array.
+// Holds the string name of each identifier in one pool of characters, and
+// the offset of each name in it. Unlike an array of pointers, neither needs
+// relocating when a position-independent program is loaded.
 // Example:
-//  char *color_strs[5];
-char *XENUM_GLUE(XNAME, strs)[
-    #include XENUM_FILE(XNAME)
-    0];
-#undef X
+//  const char color_str_pool[27];
+//  const uint32_t color_str_offsets[5];
+XDATA_EXTERN const char XENUM_GLUE(XNAME, str_pool)[sizeof(struct XENUM_GLUE(XNAME, str_layout))];
+XDATA_EXTERN const uint32_t XENUM_GLUE(XNAME, str_offsets)[XENUM_GLUE(XNAME, identifiers)];
 
 #if XGROUP
 
 // Holds the group of each identifier in an array.
 // Example:
 //  int color_groups[5];
-#define X(identifier) 1+
-int XENUM_GLUE(XNAME, groups)[
-    #include XENUM_FILE(XNAME)
-    0];
-#undef X
+XDATA_EXTERN int XENUM_GLUE(XNAME, groups)[XENUM_GLUE(XNAME, identifiers)];
 
 #endif // XGROUP
 
 ////////// Function declarations. Refer to their definitions for documentation.
 
-unsigned int XENUM_GLUE(XNAME, index)(XNAME value);
-char *XENUM_GLUE(XNAME, str)(XNAME value);
-void XENUM_GLUE(XNAME, iter)(int callback(XNAME));
+XDATA_FUNC unsigned int XENUM_GLUE(XNAME, index)(XNAME value);
+XDATA_FUNC int XENUM_GLUE(XNAME, is_valid)(XNAME value);
+XDATA_FUNC const char *XENUM_GLUE(XNAME, str)(XNAME value);
+XDATA_FUNC void XENUM_GLUE(XNAME, iter)(int callback(XNAME));
+XDATA_FUNC size_t XENUM_GLUE(XNAME, index_batch)(const XNAME *values, size_t n, unsigned int *out);
+XDATA_FUNC size_t XENUM_GLUE(XNAME, str_batch)(const XNAME *values, size_t n, const char **out);
+XDATA_FUNC XNAME XENUM_GLUE(XNAME, from_str)(const char *s, size_t len);
+XDATA_FUNC XNAME XENUM_GLUE(XNAME, from_str_nocase)(const char *s, size_t len);
 
 #if XGROUP
-int XENUM_GLUE(XNAME, group)(XNAME value);
-void XENUM_GLUE(XNAME, group_iter)(int group, int callback(XNAME));
+XDATA_FUNC int XENUM_GLUE(XNAME, group)(XNAME value);
+XDATA_FUNC int XENUM_GLUE(XNAME, is_in_group)(XNAME value, int group);
+XDATA_FUNC const unsigned int *XENUM_GLUE(XNAME, group_indices)(int group, unsigned int *count);
+XDATA_FUNC void XENUM_GLUE(XNAME, group_iter)(int group, int callback(XNAME));
+XDATA_FUNC size_t XENUM_GLUE(XNAME, group_batch)(const XNAME *values, size_t n, int *out);
 #endif
 
+#if XFLAGS
+XDATA_FUNC void XENUM_GLUE(XNAME, mask_iter)(unsigned int mask, int callback(XNAME));
+XDATA_FUNC size_t XENUM_GLUE(XNAME, mask_str)(unsigned int mask, char *buf, size_t cap);
+XDATA_FUNC int XENUM_GLUE(XNAME, mask_from_str)(const char *s, size_t len, unsigned int *mask);
+#endif
+
+XDATA_FUNC int XENUM_GLUE(XNAME, map_init)(XENUM_GLUE(XNAME, map) *map, size_t value_size);
+XDATA_FUNC void XENUM_GLUE(XNAME, map_free)(XENUM_GLUE(XNAME, map) *map);
+XDATA_FUNC void *XENUM_GLUE(XNAME, map_get)(const XENUM_GLUE(XNAME, map) *map, XNAME key);
+XDATA_FUNC void *XENUM_GLUE(XNAME, map_put)(XENUM_GLUE(XNAME, map) *map, XNAME key);
+XDATA_FUNC int XENUM_GLUE(XNAME, map_remove)(XENUM_GLUE(XNAME, map) *map, XNAME key);
+XDATA_FUNC void XENUM_GLUE(XNAME, map_clear)(XENUM_GLUE(XNAME, map) *map);
+XDATA_FUNC void XENUM_GLUE(XNAME, map_iter)(XENUM_GLUE(XNAME, map) *map, int callback(XNAME, void *));
+
 #ifdef XDATA_OWNER
 // Everything in this block should only show up in a single compilation unit
 // for each enum.
@@ -160,26 +533,33 @@ void XENUM_GLUE(XNAME, group_iter)(int group, int callback(XNAME));
 // Create the enum count.
 // Example:
 //  int color_count = 5;
-#define X(identifier) 1+
-int XENUM_GLUE(XNAME, count) =
-        #include XENUM_FILE(XNAME)
-        0;
-#undef X
+XDATA_STATIC int XENUM_GLUE(XNAME, count) = XENUM_GLUE(XNAME, identifiers);
 
 // Create the value array.
 // Example:
 //  color color_values[] = { Red, Green, Blue, White, Black };
 #define X(identifier) XENUM_ID(identifier),
-XNAME XENUM_GLUE(XNAME, values)[] = {
+XDATA_STATIC XNAME XENUM_GLUE(XNAME, values)[] = {
     #include XENUM_FILE(XNAME)
 };
 #undef X
 
-// Create the string array.
+// Create the string pool, as one string literal with a terminator after each
+// name. The last terminator is the literal's own, which the array's size
+// leaves out.
+// Example:
+//  const char color_str_pool[27] = "Red\0" "Green\0" "Blue\0" "White\0" "Black\0";
+#define X(identifier) XENUM_STR(XENUM_ID(identifier)) "\0"
+XDATA_STATIC const char XENUM_GLUE(XNAME, str_pool)[sizeof(struct XENUM_GLUE(XNAME, str_layout))] =
+    #include XENUM_FILE(XNAME)
+    ;
+#undef X
+
+// Create the array of string offsets.
 // Example:
-//  char *color_strs[] = { "Red", "Green", "Blue", "White", "Black" };
-#define X(identifier) XENUM_STR(XENUM_ID(identifier)),
-char *XENUM_GLUE(XNAME, strs)[] = {
+//  const uint32_t color_str_offsets[] = { 0, 4, 10, 15, 21 };
+#define X(identifier) offsetof(struct XENUM_GLUE(XNAME, str_layout), XENUM_ID(identifier)),
+XDATA_STATIC const uint32_t XENUM_GLUE(XNAME, str_offsets)[] = {
     #include XENUM_FILE(XNAME)
 };
 #undef X
@@ -192,41 +572,182 @@ char *XENUM_GLUE(XNAME, strs)[] = {
 #define X(identifier)
 #undef GROUP
 #define GROUP(g) g,
-int XENUM_GLUE(XNAME, groups)[] = {
+XDATA_STATIC int XENUM_GLUE(XNAME, groups)[] = {
     #include XENUM_FILE(XNAME)
 };
 #undef GROUP
 #define GROUP(g)
 #undef X
 
+// Holds the index of every identifier, sorted by group, and where each group
+// starts in it, indexed by group minus the lowest group. Like the hash table,
+// this is filled in on first use.
+// Example:
+//  static unsigned int color_group_offsets[3];   // { 0, 3, 5 }
+//  static unsigned int color_group_members[5];   // { 0, 1, 2, 3, 4 }
+static unsigned int XENUM_GLUE(XNAME, group_offsets)[XENUM_GLUE(XNAME, group_slots) + 1];
+static unsigned int XENUM_GLUE(XNAME, group_members)[XENUM_GLUE(XNAME, identifiers)];
+static atomic_int XENUM_GLUE(XNAME, group_state);
+
 #endif // XGROUP
 
+#if XVALUE
+
+// Holds the lookup table. Dense enums place each index plus one at its value's
+// offset from the lowest value, with zero in unused slots; sparse enums hold
+// every index, sorted by value. Explicit values may alias each other, and the
+// first identifier with a value wins, which the preprocessor can't work out,
+// so it's filled in on first use.
+// Example:
+//  static unsigned int color_lookup[12];   // { 1, 2, 3, 0, ..., 0, 4, 5 }
+static unsigned int XENUM_GLUE(XNAME, lookup)[XENUM_GLUE(XNAME, lookups)];
+static atomic_int XENUM_GLUE(XNAME, lookup_state);
+
+#else // XVALUE
+
+// Create the lookup table. Without explicit values no two identifiers share a
+// value, so it's built at compile time: dense enums place each index plus one
+// at its value's offset from the lowest value, and sparse flag enums fill the
+// table in order so that the designators never collide, but never read it.
+// Example:
+//  const unsigned int permission_lookup[] = { [0] = 1, [1] = 2, [3] = 3 };
+#define X(identifier)                                                           \
+    [XENUM_GLUE(XNAME, dense) ?                                                 \
+        (long long)XENUM_ID(identifier) - XENUM_GLUE(XNAME, lowest) :           \
+        XENUM_GLUE(XENUM_GLUE(XNAME, index), XENUM_ID(identifier))] =           \
+    XENUM_GLUE(XENUM_GLUE(XNAME, index), XENUM_ID(identifier)) + 1,
+static const unsigned int XENUM_GLUE(XNAME, lookup)[XENUM_GLUE(XNAME, lookups)] = {
+    #include XENUM_FILE(XNAME)
+};
+#undef X
+
+#endif // XVALUE
+
+// Create the array of string lengths.
+// Example:
+//  static const unsigned int color_lengths[] = { 3, 5, 4, 5, 5 };
+#define X(identifier) sizeof(XENUM_STR(XENUM_ID(identifier))) - 1,
+static const unsigned int XENUM_GLUE(XNAME, lengths)[] = {
+    #include XENUM_FILE(XNAME)
+};
+#undef X
+
+// Holds the hash table used to look up identifiers by name, using linear
+// probing. Each slot holds an index plus one, or zero if it's empty. The
+// preprocessor can't hash strings, so it's filled in on first use.
+// Example:
+//  static unsigned int color_hash_table[16];
+static unsigned int XENUM_GLUE(XNAME, hash_table)[XENUM_GLUE(XNAME, hashes)];
+static atomic_int XENUM_GLUE(XNAME, hash_state);
+
 ////////// Function definitions.
 
-// Get the index of the given value. Returns -1 for invalid values.
+#if XVALUE
+
+// Order indices by their values, then by index, so the first of several
+// identifiers sharing a value sorts first.
+// Example:
+//  static int color_lookup_cmp(const void *a, const void *b) { ... }
+static int XENUM_GLUE(XNAME, lookup_cmp)(const void *a, const void *b) {
+    unsigned int i = *(const unsigned int *)a, j = *(const unsigned int *)b;
+    XNAME x = XENUM_GLUE(XNAME, values)[i], y = XENUM_GLUE(XNAME, values)[j];
+    if (x != y) {
+        return x < y ? -1 : 1;
+    }
+    return i < j ? -1 : i > j;
+}
+
+// Fill in the lookup table. Dense enums go through the identifiers backwards
+// so the first of each value is written last. Called through xenum_once().
+// Example:
+//  static void color_lookup_init(void) { ... }
+static void XENUM_GLUE(XNAME, lookup_init)(void) {
+    unsigned int *lookup = XENUM_GLUE(XNAME, lookup);
+    unsigned int i;
+    if (XENUM_GLUE(XNAME, dense)) {
+        for (i = XENUM_GLUE(XNAME, identifiers); i-- > 0;) {
+            lookup[(unsigned int)XENUM_GLUE(XNAME, values)[i] -
+                    (unsigned int)XENUM_GLUE(XNAME, lowest)] = i + 1;
+        }
+        return;
+    }
+    for (i = 0; i < XENUM_GLUE(XNAME, identifiers); i++) {
+        lookup[i] = i;
+    }
+    qsort(lookup, XENUM_GLUE(XNAME, identifiers), sizeof(*lookup),
+            XENUM_GLUE(XNAME, lookup_cmp));
+}
+
+#endif // XVALUE
+
+// Get the index of the given value. Returns -1 for invalid values. Dense enums
+// use a single table lookup; sparse enums binary search the table. When
+// identifiers share a value, the first one's index is returned. Flag enums
+// count the value's trailing zeros instead.
 // Example:
 //  unsigned int color_index(color value) { ... }
-unsigned int XENUM_GLUE(XNAME, index)(XNAME value) {
-    int i;
-    for (i = 0; i < XENUM_GLUE(XNAME, count); i++) {
-        if (value == XENUM_GLUE(XNAME, values)[i]) {
-            return i;
+XDATA_FUNC unsigned int XENUM_GLUE(XNAME, index)(XNAME value) {
+    unsigned int offset = (unsigned int)value - (unsigned int)XENUM_GLUE(XNAME, lowest);
+#if XFLAGS
+    unsigned int bits = (unsigned int)value;
+    if (bits != 0 && (bits & (bits - 1)) == 0 && bits <= XENUM_GLUE(XNAME, all)) {
+        return XENUM_CTZ(bits);
+    }
+    return -1;
+#endif // XFLAGS
+#if XVALUE
+    // Check the state here first, so the common case costs a load rather
+    // than a call.
+    if (atomic_load_explicit(&XENUM_GLUE(XNAME, lookup_state), memory_order_acquire) != 2) {
+        xenum_once(&XENUM_GLUE(XNAME, lookup_state), XENUM_GLUE(XNAME, lookup_init));
+    }
+    if (!XENUM_GLUE(XNAME, dense)) {
+        const unsigned int *lookup = XENUM_GLUE(XNAME, lookup);
+        unsigned int low = 0, high = XENUM_GLUE(XNAME, identifiers), middle;
+        if (offset > (unsigned int)XENUM_GLUE(XNAME, highest) -
+                (unsigned int)XENUM_GLUE(XNAME, lowest)) {
+            return -1;
+        }
+        // Find the first index whose value isn't below the one given.
+        while (low < high) {
+            middle = low + (high - low) / 2;
+            if (XENUM_GLUE(XNAME, values)[lookup[middle]] < value) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
         }
+        return low < XENUM_GLUE(XNAME, identifiers) &&
+                XENUM_GLUE(XNAME, values)[lookup[low]] == value ? lookup[low] : (unsigned int)-1;
+    }
+#endif // XVALUE
+    if (offset < XENUM_GLUE(XNAME, lookups)) {
+        return XENUM_GLUE(XNAME, lookup)[offset] - 1;
     }
     return -1;
 }
 
-// Get the string name of the given value.
+// Check whether the value is one of the enum's identifiers, for input that
+// can't be trusted. Values outside color_lowest..color_highest are rejected
+// with one comparison; dense enums then need one table lookup.
+// Example:
+//  int color_is_valid(color value) { ... }
+XDATA_FUNC int XENUM_GLUE(XNAME, is_valid)(XNAME value) {
+    return XENUM_GLUE(XNAME, index)(value) != (unsigned int)-1;
+}
+
+// Get the string name of the given value, or NULL for invalid values.
 // Example:
-//  char *color_str(color value) { ... }
-char *XENUM_GLUE(XNAME, str)(XNAME value) {
-    return XENUM_GLUE(XNAME, strs)[XENUM_GLUE(XNAME, index)(value)];
+//  const char *color_str(color value) { ... }
+XDATA_FUNC const char *XENUM_GLUE(XNAME, str)(XNAME value) {
+    unsigned int i = XENUM_GLUE(XNAME, index)(value);
+    return i < XENUM_GLUE(XNAME, identifiers) ? XENUM_POOL(XENUM_GLUE(XNAME, str), i) : NULL;
 }
 
 // Call the given function with each value until it returns nonzero.
 // Example:
 //  void color_iter(int callback(color)) { ... }
-void XENUM_GLUE(XNAME, iter)(int callback(XNAME)) {
+XDATA_FUNC void XENUM_GLUE(XNAME, iter)(int callback(XNAME)) {
     int i;
     for (i = 0; i < XENUM_GLUE(XNAME, count); i++) {
         if (callback(XENUM_GLUE(XNAME, values)[i])) {
@@ -235,29 +756,363 @@ void XENUM_GLUE(XNAME, iter)(int callback(XNAME)) {
     }
 }
 
+// Get the index of each of n values, like index(), writing -1 for invalid
+// ones. Returns how many were invalid. Dense enums convert the whole array
+// through the lookup table in one pass, eight values at a time with AVX2.
+// Example:
+//  size_t color_index_batch(const color *values, size_t n, unsigned int *out) { ... }
+_Static_assert(sizeof(XNAME) == sizeof(int), "batch functions read enums as ints");
+XDATA_FUNC size_t XENUM_GLUE(XNAME, index_batch)(const XNAME *values, size_t n, unsigned int *out) {
+    size_t invalid = 0, i;
+    if (XENUM_GLUE(XNAME, dense)) {
+#if XVALUE
+        xenum_once(&XENUM_GLUE(XNAME, lookup_state), XENUM_GLUE(XNAME, lookup_init));
+#endif // XVALUE
+        return xenum_lookup_batch((const int *)values, n, XENUM_GLUE(XNAME, lookup),
+                XENUM_GLUE(XNAME, lookups), XENUM_GLUE(XNAME, lowest), out);
+    }
+    for (i = 0; i < n; i++) {
+        out[i] = XENUM_GLUE(XNAME, index)(values[i]);
+        invalid += out[i] == (unsigned int)-1;
+    }
+    return invalid;
+}
+
+// Get the string name of each of n values, like str(), writing NULL for
+// invalid ones. Returns how many were invalid.
+// Example:
+//  size_t color_str_batch(const color *values, size_t n, const char **out) { ... }
+XDATA_FUNC size_t XENUM_GLUE(XNAME, str_batch)(const XNAME *values, size_t n, const char **out) {
+    unsigned int indices[XENUM_BATCH];
+    size_t invalid = 0, i, j, count;
+    for (i = 0; i < n; i += count) {
+        count = n - i < XENUM_BATCH ? n - i : XENUM_BATCH;
+        invalid += XENUM_GLUE(XNAME, index_batch)(values + i, count, indices);
+        for (j = 0; j < count; j++) {
+            out[i + j] = indices[j] < XENUM_GLUE(XNAME, identifiers) ?
+                    XENUM_POOL(XENUM_GLUE(XNAME, str), indices[j]) : NULL;
+        }
+    }
+    return invalid;
+}
+
+// Insert every identifier into the hash table. Called through xenum_once().
+// Example:
+//  static void color_hash_init(void) { ... }
+static void XENUM_GLUE(XNAME, hash_init)(void) {
+    unsigned int i, slot;
+    for (i = 0; i < XENUM_GLUE(XNAME, identifiers); i++) {
+        slot = xenum_hash(XENUM_POOL(XENUM_GLUE(XNAME, str), i),
+                XENUM_GLUE(XNAME, lengths)[i]);
+        slot &= XENUM_GLUE(XNAME, hashes) - 1;
+        while (XENUM_GLUE(XNAME, hash_table)[slot]) {
+            slot = (slot + 1) & (XENUM_GLUE(XNAME, hashes) - 1);
+        }
+        XENUM_GLUE(XNAME, hash_table)[slot] = i + 1;
+    }
+}
+
+// Get the index of the identifier with the given name, or -1 if there is none.
+// Example:
+//  static unsigned int color_find(const char *s, size_t len, int nocase) { ... }
+static unsigned int XENUM_GLUE(XNAME, find)(const char *s, size_t len, int nocase) {
+    unsigned int i, slot;
+    xenum_once(&XENUM_GLUE(XNAME, hash_state), XENUM_GLUE(XNAME, hash_init));
+    slot = xenum_hash(s, len) & (XENUM_GLUE(XNAME, hashes) - 1);
+    while ((i = XENUM_GLUE(XNAME, hash_table)[slot])) {
+        i--;
+        if (XENUM_GLUE(XNAME, lengths)[i] == len &&
+                xenum_equal(XENUM_POOL(XENUM_GLUE(XNAME, str), i), s, len, nocase)) {
+            return i;
+        }
+        slot = (slot + 1) & (XENUM_GLUE(XNAME, hashes) - 1);
+    }
+    return -1;
+}
+
+// Get the value whose name matches the first len characters of the string, or
+// the "max" identifier if there is none.
+// Example:
+//  color color_from_str(const char *s, size_t len) { ... }
+XDATA_FUNC XNAME XENUM_GLUE(XNAME, from_str)(const char *s, size_t len) {
+    unsigned int i = XENUM_GLUE(XNAME, find)(s, len, 0);
+    if (i == (unsigned int)-1) {
+        return XENUM_GLUE(XNAME, max);
+    }
+    return XENUM_GLUE(XNAME, values)[i];
+}
+
+// Same as above, but ignores ASCII case. If several names only differ by case,
+// the first one wins.
+// Example:
+//  color color_from_str_nocase(const char *s, size_t len) { ... }
+XDATA_FUNC XNAME XENUM_GLUE(XNAME, from_str_nocase)(const char *s, size_t len) {
+    unsigned int i = XENUM_GLUE(XNAME, find)(s, len, 1);
+    if (i == (unsigned int)-1) {
+        return XENUM_GLUE(XNAME, max);
+    }
+    return XENUM_GLUE(XNAME, values)[i];
+}
+
 #if XGROUP
-// Get the group of the given value.
+// Get the group of the given value, or -1 for invalid values.
 // Example:
 //  int color_group(color value) { ... }
-int XENUM_GLUE(XNAME, group)(XNAME value) {
-    return XENUM_GLUE(XNAME, groups)[XENUM_GLUE(XNAME, index)(value)];
+XDATA_FUNC int XENUM_GLUE(XNAME, group)(XNAME value) {
+    unsigned int i = XENUM_GLUE(XNAME, index)(value);
+    return i < XENUM_GLUE(XNAME, identifiers) ? XENUM_GLUE(XNAME, groups)[i] : -1;
+}
+
+// Check whether the value belongs to the group. This is a single lookup, and
+// invalid values belong to no group.
+// Example:
+//  int color_is_in_group(color value, int group) { ... }
+XDATA_FUNC int XENUM_GLUE(XNAME, is_in_group)(XNAME value, int group) {
+    unsigned int i = XENUM_GLUE(XNAME, index)(value);
+    return i < XENUM_GLUE(XNAME, identifiers) && XENUM_GLUE(XNAME, groups)[i] == group;
+}
+
+// Sort the indices by group, keeping their order within each group. Called
+// through xenum_once().
+// Example:
+//  static void color_group_init(void) { ... }
+static void XENUM_GLUE(XNAME, group_init)(void) {
+    unsigned int *offsets = XENUM_GLUE(XNAME, group_offsets);
+    unsigned int i, slot;
+    for (i = 0; i < XENUM_GLUE(XNAME, identifiers); i++) {
+        offsets[XENUM_GLUE(XNAME, groups)[i] - XENUM_GLUE(XNAME, group_lowest) + 1]++;
+    }
+    for (slot = 1; slot <= XENUM_GLUE(XNAME, group_slots); slot++) {
+        offsets[slot] += offsets[slot - 1];
+    }
+    // Use each group's start as a cursor, which leaves it at the next group's
+    // start, then shift the offsets back into place.
+    for (i = 0; i < XENUM_GLUE(XNAME, identifiers); i++) {
+        slot = XENUM_GLUE(XNAME, groups)[i] - XENUM_GLUE(XNAME, group_lowest);
+        XENUM_GLUE(XNAME, group_members)[offsets[slot]++] = i;
+    }
+    for (slot = XENUM_GLUE(XNAME, group_slots); slot > 0; slot--) {
+        offsets[slot] = offsets[slot - 1];
+    }
+    offsets[0] = 0;
+}
+
+// Get the indices of the identifiers in the group, in order, and store how
+// many there are in count.
+// Example:
+//  const unsigned int *color_group_indices(int group, unsigned int *count) { ... }
+XDATA_FUNC const unsigned int *XENUM_GLUE(XNAME, group_indices)(int group, unsigned int *count) {
+    unsigned int slot = (unsigned int)group - (unsigned int)XENUM_GLUE(XNAME, group_lowest);
+    xenum_once(&XENUM_GLUE(XNAME, group_state), XENUM_GLUE(XNAME, group_init));
+    if (slot >= XENUM_GLUE(XNAME, group_slots)) {
+        *count = 0;
+        return XENUM_GLUE(XNAME, group_members);
+    }
+    *count = XENUM_GLUE(XNAME, group_offsets)[slot + 1] -
+            XENUM_GLUE(XNAME, group_offsets)[slot];
+    return XENUM_GLUE(XNAME, group_members) + XENUM_GLUE(XNAME, group_offsets)[slot];
 }
 
 // Call the function with each value in the group until it returns nonzero.
+// Only the group's own identifiers are visited.
 // Example:
 //  void color_group_iter(int group, int callback(color)) { ... }
-void XENUM_GLUE(XNAME, group_iter)(int group, int callback(XNAME)) {
-    int i;
-    for (i = 0; i < XENUM_GLUE(XNAME, count); i++) {
-        if (XENUM_GLUE(XNAME, groups)[i] == group) {
-            if (callback(XENUM_GLUE(XNAME, values)[i])) {
-                return;
-            }
+XDATA_FUNC void XENUM_GLUE(XNAME, group_iter)(int group, int callback(XNAME)) {
+    unsigned int i, count;
+    const unsigned int *indices = XENUM_GLUE(XNAME, group_indices)(group, &count);
+    for (i = 0; i < count; i++) {
+        if (callback(XENUM_GLUE(XNAME, values)[indices[i]])) {
+            return;
         }
     }
 }
+
+// Get the group of each of n values, like group(), writing -1 for invalid
+// ones. Returns how many were invalid.
+// Example:
+//  size_t color_group_batch(const color *values, size_t n, int *out) { ... }
+XDATA_FUNC size_t XENUM_GLUE(XNAME, group_batch)(const XNAME *values, size_t n, int *out) {
+    unsigned int indices[XENUM_BATCH];
+    size_t invalid = 0, i, j, count;
+    for (i = 0; i < n; i += count) {
+        count = n - i < XENUM_BATCH ? n - i : XENUM_BATCH;
+        invalid += XENUM_GLUE(XNAME, index_batch)(values + i, count, indices);
+        for (j = 0; j < count; j++) {
+            out[i + j] = indices[j] < XENUM_GLUE(XNAME, identifiers) ?
+                    XENUM_GLUE(XNAME, groups)[indices[j]] : -1;
+        }
+    }
+    return invalid;
+}
 #endif // XGROUP
 
+#if XFLAGS
+// Call the function with each flag set in the mask, in order, until it
+// returns nonzero. Only set bits are visited, and bits past the last flag are
+// ignored.
+// Example:
+//  void permission_mask_iter(unsigned int mask, int callback(permission)) { ... }
+XDATA_FUNC void XENUM_GLUE(XNAME, mask_iter)(unsigned int mask, int callback(XNAME)) {
+    for (mask &= XENUM_GLUE(XNAME, all); mask != 0; mask &= mask - 1) {
+        if (callback(XENUM_GLUE(XNAME, values)[XENUM_CTZ(mask)])) {
+            return;
+        }
+    }
+}
+
+// Write the names of the flags set in the mask into the buffer, separated by
+// '|', like "Read|Write". An empty mask writes an empty string, and bits past
+// the last flag are ignored. Like snprintf(), it writes at most cap bytes,
+// always terminates the string if cap is nonzero, and returns the length of
+// the full string.
+// Example:
+//  size_t permission_mask_str(unsigned int mask, char *buf, size_t cap) { ... }
+XDATA_FUNC size_t XENUM_GLUE(XNAME, mask_str)(unsigned int mask, char *buf, size_t cap) {
+    size_t length = 0, size;
+    const char *name;
+    for (mask &= XENUM_GLUE(XNAME, all); mask != 0; mask &= mask - 1) {
+        if (length > 0) {
+            if (length < cap) {
+                buf[length] = '|';
+            }
+            length++;
+        }
+        name = XENUM_POOL(XENUM_GLUE(XNAME, str), XENUM_CTZ(mask));
+        size = strlen(name);
+        if (length < cap) {
+            memcpy(buf + length, name, length + size < cap ? size : cap - length);
+        }
+        length += size;
+    }
+    if (cap > 0) {
+        buf[length < cap ? length : cap - 1] = '\0';
+    }
+    return length;
+}
+
+// Parse names separated by '|', with optional spaces around them, into a
+// mask, the reverse of mask_str(). Returns 0 on success, or -1 if a name
+// isn't a flag, leaving the mask untouched.
+// Example:
+//  int permission_mask_from_str(const char *s, size_t len, unsigned int *mask) { ... }
+XDATA_FUNC int XENUM_GLUE(XNAME, mask_from_str)(const char *s, size_t len, unsigned int *mask) {
+    unsigned int result = 0, i;
+    size_t start = 0, end, next;
+    while (start < len) {
+        for (next = start; next < len && s[next] != '|'; next++) {
+        }
+        for (end = next; end > start && s[end - 1] == ' '; end--) {
+        }
+        while (start < end && s[start] == ' ') {
+            start++;
+        }
+        if (start < end) {
+            i = XENUM_GLUE(XNAME, find)(s + start, end - start, 0);
+            if (i == (unsigned int)-1) {
+                return -1;
+            }
+            result |= 1u << i;
+        }
+        start = next + 1;
+    }
+    *mask = result;
+    return 0;
+}
+#endif // XFLAGS
+
+// Set up an empty map whose values are value_size bytes each, allocating
+// every slot up front. Returns 0 on success, or -1 if the allocation failed or
+// its size would overflow.
+// Example:
+//  int color_map_init(color_map *map, size_t value_size) { ... }
+XDATA_FUNC int XENUM_GLUE(XNAME, map_init)(XENUM_GLUE(XNAME, map) *map, size_t value_size) {
+    size_t size;
+    memset(map, 0, sizeof(*map));
+    if (value_size > SIZE_MAX / XENUM_GLUE(XNAME, identifiers)) {
+        return -1;
+    }
+    size = XENUM_GLUE(XNAME, identifiers) * (value_size ? value_size : 1);
+    map->values = XDATA_ALLOC(size);
+    if (map->values == NULL) {
+        return -1;
+    }
+    memset(map->values, 0, size);
+    map->value_size = value_size;
+    return 0;
+}
+
+// Free the map's values and reset it to be empty.
+// Example:
+//  void color_map_free(color_map *map) { ... }
+XDATA_FUNC void XENUM_GLUE(XNAME, map_free)(XENUM_GLUE(XNAME, map) *map) {
+    XDATA_FREE(map->values);
+    memset(map, 0, sizeof(*map));
+}
+
+// Get a pointer to the key's value, or NULL if it isn't in the map.
+// Example:
+//  void *color_map_get(const color_map *map, color key) { ... }
+XDATA_FUNC void *XENUM_GLUE(XNAME, map_get)(const XENUM_GLUE(XNAME, map) *map, XNAME key) {
+    unsigned int i = XENUM_GLUE(XNAME, index)(key);
+    if (i >= XENUM_GLUE(XNAME, identifiers) || !map->present[i]) {
+        return NULL;
+    }
+    return map->values + i * map->value_size;
+}
+
+// Get a pointer to the key's value, adding the key with a zeroed value if it
+// isn't in the map yet. Returns NULL for invalid keys.
+// Example:
+//  void *color_map_put(color_map *map, color key) { ... }
+XDATA_FUNC void *XENUM_GLUE(XNAME, map_put)(XENUM_GLUE(XNAME, map) *map, XNAME key) {
+    unsigned int i = XENUM_GLUE(XNAME, index)(key);
+    if (i >= XENUM_GLUE(XNAME, identifiers)) {
+        return NULL;
+    }
+    if (!map->present[i]) {
+        map->present[i] = 1;
+        map->length++;
+    }
+    return map->values + i * map->value_size;
+}
+
+// Remove the key from the map. Returns 1 if it was there, or 0 otherwise.
+// Example:
+//  int color_map_remove(color_map *map, color key) { ... }
+XDATA_FUNC int XENUM_GLUE(XNAME, map_remove)(XENUM_GLUE(XNAME, map) *map, XNAME key) {
+    unsigned int i = XENUM_GLUE(XNAME, index)(key);
+    if (i >= XENUM_GLUE(XNAME, identifiers) || !map->present[i]) {
+        return 0;
+    }
+    memset(map->values + i * map->value_size, 0, map->value_size);
+    map->present[i] = 0;
+    map->length--;
+    return 1;
+}
+
+// Remove every key from the map, keeping its storage.
+// Example:
+//  void color_map_clear(color_map *map) { ... }
+XDATA_FUNC void XENUM_GLUE(XNAME, map_clear)(XENUM_GLUE(XNAME, map) *map) {
+    memset(map->values, 0, XENUM_GLUE(XNAME, identifiers) * map->value_size);
+    memset(map->present, 0, sizeof(map->present));
+    map->length = 0;
+}
+
+// Call the function with each key in the map and a pointer to its value, in
+// the enum's order, until it returns nonzero.
+// Example:
+//  void color_map_iter(color_map *map, int callback(color, void *)) { ... }
+XDATA_FUNC void XENUM_GLUE(XNAME, map_iter)(XENUM_GLUE(XNAME, map) *map, int callback(XNAME, void *)) {
+    int i;
+    for (i = 0; i < XENUM_GLUE(XNAME, identifiers); i++) {
+        if (map->present[i] && callback(XENUM_GLUE(XNAME, values)[i],
+                map->values + i * map->value_size)) {
+            return;
+        }
+    }
+}
+
 #endif // XDATA_OWNER
 
 ////////// Cleanup.
@@ -277,10 +1132,19 @@ void XENUM_GLUE(XNAME, group_iter)(int group, int callback(XNAME)) {
 #define VALUE(v)
 #endif // XVALUE
 
+#if XFLAGS
+#undef XFLAGS
+#endif // XFLAGS
+
 #ifdef XPREFIX
 #undef XPREFIX
 #endif // XPREFIX
 #undef XENUM_ID
 
+#ifdef XLIST
+#undef XLIST
+#endif // XLIST
+#undef XENUM_FILE
+
 #undef XENUM_H_NESTED_
 #endif // XENUM_H_NESTED_
@@ -0,0 +1,3 @@
+// Expands the X() list of a definition that uses the XLIST option. Included by
+// xenum.h and xstruct.h in place of the enum.*.h or struct.*.h file itself.
+XLIST
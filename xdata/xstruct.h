@@ -29,302 +29,2704 @@
 #define GROUP(g)
 #endif
 
+// XLIST: take the members from the XLIST macro instead of the rest of the
+// struct.*.h file, like the enum option of the same name.
+// Usage:
+//  #define XLIST X(type, member1) X(type, member2)
+#ifdef XLIST
+#define XSTRUCT_FILE(name) "xlist.h"
+#else // XLIST
+#define XSTRUCT_FILE(name) XENUM_STR(struct.name.h)
+#endif // XLIST
+
+// XPACKED: also create a packed copy of the struct, without any padding, and
+// functions to convert between the two. pixel_fprint_layout() shows what it saves.
+// Usage:
+//  #define XPACKED 1
+//     X(type, member)
+
+// XSOA: also create a struct of arrays with a column per member, and functions
+// to move structs in and out of it. They're code per member, which takes the
+// compiler a long time on very large structs, so only ask for them when needed.
+// Usage:
+//  #define XSOA 1
+//     X(type, member)
+
 #ifndef XSTRUCT_H_
 #define XSTRUCT_H_
 // Everything in this block should only show up once per compilation unit.
 
-#include <stdint.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include <float.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef __STDC_NO_THREADS__
+#include <threads.h>
+#endif
+
+// Internal macros.
+#define XSTRUCT_STR_EXPANDED(identifier) #identifier
+#define XSTRUCT_STR(identifier) XSTRUCT_STR_EXPANDED(identifier)
+#define XSTRUCT_GLUE_EXPANDED(prefix, suffix) prefix ## _ ## suffix
+#define XSTRUCT_GLUE(prefix, suffix) XSTRUCT_GLUE_EXPANDED(prefix, suffix)
+
+#include "xtypes.h"
+
+// Create an enum of the types in xtypes.h. Members of any other type are
+// tagged xstruct_type_other and printed as pointers.
+// Example:
+//  typedef enum { xstruct_type_bool, xstruct_type_char, ..., xstruct_type_other } xstruct_type;
+#define XSTRUCT_TYPE_TAG(type, format, tag) XSTRUCT_GLUE(xstruct_type, tag),
+typedef enum {
+    XTYPES(XSTRUCT_TYPE_TAG)
+    xstruct_type_other
+} xstruct_type;
+#undef XSTRUCT_TYPE_TAG
+
+// Get the xstruct_type of an expression at compile time.
+#define XSTRUCT_TYPE_CASE(type, format, tag) type: XSTRUCT_GLUE(xstruct_type, tag),
+#define XSTRUCT_TYPE(expression) \
+    _Generic((expression), XTYPES(XSTRUCT_TYPE_CASE) default: xstruct_type_other)
+
+// The number of bytes that hold a long double's value. x87 long doubles keep
+// 10 bytes of value in 12 or 16 bytes of storage, and the rest is garbage that
+// comparing and hashing skip.
+#if LDBL_MANT_DIG == 64 && (defined(__i386__) || defined(__x86_64__))
+#define XSTRUCT_LDOUBLE_SIZE 10
+#else
+#define XSTRUCT_LDOUBLE_SIZE sizeof(long double)
+#endif
+
+// Get the number of bytes that hold the value of an expression, or of a member
+// of the given type and size.
+#define XSTRUCT_VALUE_SIZE(expression)                                          \
+    (XSTRUCT_TYPE(expression) == xstruct_type_ldouble ?                         \
+            (size_t)XSTRUCT_LDOUBLE_SIZE : sizeof(expression))
+#define XSTRUCT_VALUE_SIZE_OF(type, size)                                       \
+    ((type) == xstruct_type_ldouble ? (size_t)XSTRUCT_LDOUBLE_SIZE : (size))
+
+// Holds the printf format string of each type, indexed by xstruct_type.
+XDATA_EXTERN const char *xstruct_formats[xstruct_type_other + 1];
+
+// Alignment of each column in a struct of arrays, which is enough for a cache
+// line or the widest vector registers.
+#define XSTRUCT_SOA_ALIGN 64
+#define XSTRUCT_SOA_ROUND(size) \
+    (((size) + XSTRUCT_SOA_ALIGN - 1) & ~(size_t)(XSTRUCT_SOA_ALIGN - 1))
+
+// The smallest capacity of a map. Maps double in size once they'd be more
+// than 3/4 full.
+#define XSTRUCT_MAP_MIN 16
+
+// The longest LEB128 encoding of a 64-bit number.
+#define XSTRUCT_VARINT_MAX 10
+
+// The cache line size assumed by the layout report.
+#define XSTRUCT_CACHE_LINE 64
+
+// How many times a reader finds a store in progress before it yields, in case
+// the writer was preempted in the middle of one. Yielding needs C11 threads.
+#define XSTRUCT_SEQLOCK_SPINS 64
+#ifndef __STDC_NO_THREADS__
+#define XSTRUCT_YIELD() thrd_yield()
+#else
+#define XSTRUCT_YIELD()
+#endif
+
+// The longest format string the print and parse functions accept, once a
+// type's printf conversion is substituted into it. They fail on longer ones.
+#define XSTRUCT_PRINT_LENGTH 128
+
+// The longest value text parse() accepts, which fits any double printed by %f.
+#define XSTRUCT_PARSE_LENGTH 512
+
+// Loop over a pointer to each member of a struct without calling back through
+// a function pointer.
+// Usage:
+//  void *member;
+//  XSTRUCT_FOREACH(pixel, &p, member) { ... }
+#define XSTRUCT_FOREACH(name, structure, member)                                \
+    for (int xstruct_i_ = 0; xstruct_i_ < XSTRUCT_GLUE(name, members) &&        \
+            ((member) = (char *)(structure) +                                   \
+            XSTRUCT_GLUE(name, offsets)[xstruct_i_], 1); xstruct_i_++)
+
+// Loop over a pointer to each member in a group. Requires XGROUP. Like
+// XENUM_FOREACH_IN_GROUP, the outer two loops only run once, to keep the
+// group indices read-only.
+// Usage:
+//  void *member;
+//  XSTRUCT_FOREACH_IN_GROUP(pixel, &p, member, pix_pos) { ... }
+#define XSTRUCT_FOREACH_IN_GROUP(name, structure, member, group)                \
+    for (int xstruct_n_, xstruct_once_ = 1; xstruct_once_; xstruct_once_ = 0)   \
+    for (const int *xstruct_g_ =                                                \
+            XSTRUCT_GLUE(name, group_indices)(group, &xstruct_n_);              \
+            xstruct_once_; xstruct_once_ = 0)                                   \
+    for (int xstruct_i_ = 0; xstruct_i_ < xstruct_n_ &&                         \
+            ((member) = (char *)(structure) +                                   \
+            XSTRUCT_GLUE(name, offsets)[xstruct_g_[xstruct_i_]], 1); xstruct_i_++)
+
+// Serialized records are little-endian, so big-endian hosts reverse the bytes
+// of each member on the way in and out. Schemas describe structs in memory, so
+// they give the host's byte order, in numpy's notation.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define XSTRUCT_COPY_LE(dst, src, size) xstruct_reverse(dst, src, size)
+#define XSTRUCT_BYTE_ORDER '>'
+#else
+#define XSTRUCT_COPY_LE(dst, src, size) memcpy(dst, src, size)
+#define XSTRUCT_BYTE_ORDER '<'
+#endif
+
+// Overrides XDATA_ALLOC for a single call to a print function's _with variant.
+// Strings from that call are released with the allocator's free().
+typedef struct xstruct_allocator {
+    void *(*alloc)(void *context, size_t size);
+    void (*free)(void *context, void *ptr);
+    void *context;
+} xstruct_allocator;
+
+// A bump-pointer arena, which hands out pieces of large blocks and only
+// releases them all at once. A zeroed arena is empty and ready to use.
+typedef struct xstruct_arena_block {
+    struct xstruct_arena_block *next;
+    size_t size;
+    size_t used;
+} xstruct_arena_block;
+
+typedef struct xstruct_arena {
+    xstruct_arena_block *blocks;
+    size_t block_size;
+} xstruct_arena;
+
+// The smallest block an arena allocates when block_size isn't set. Each
+// allocation is aligned like malloc()'s, and block data starts after the
+// header rounded up to the same alignment.
+#define XSTRUCT_ARENA_BLOCK 4096
+#define XSTRUCT_ARENA_ROUND(size) (((size) + _Alignof(max_align_t) - 1) & \
+        ~(size_t)(_Alignof(max_align_t) - 1))
+
+// A run of bytes within a struct, covering one or more adjacent members.
+typedef struct xstruct_range {
+    size_t offset;
+    size_t size;
+} xstruct_range;
+
+// One member of a struct, as described to tools outside of C. The group is -1
+// for structs without XGROUP.
+typedef struct xstruct_field {
+    const char *name;
+    const char *type;
+    xstruct_type tag;
+    size_t offset;
+    size_t size;
+    int group;
+} xstruct_field;
+
+// A struct's name, size and alignment, and each of its members in declaration
+// order.
+typedef struct xstruct_schema {
+    const char *name;
+    size_t size;
+    size_t align;
+    int count;
+    const xstruct_field *fields;
+} xstruct_schema;
+
+// The literal text before the name, between the name and the value, and after
+// the value in a print() format string, used to parse its output back.
+typedef struct xstruct_pattern {
+    const char *lead;
+    size_t lead_length;
+    const char *mid;
+    size_t mid_length;
+    const char *tail;
+    size_t tail_length;
+} xstruct_pattern;
+
+// A print() format string with each type's printf conversion substituted in,
+// expanded the first time a call needs that type, so each call expands the
+// format once per type rather than once per member. Each state is zero until
+// expanded, 1 once ready, and -1 if the expansion failed.
+typedef struct xstruct_formatter {
+    const char *format;
+    signed char states[xstruct_type_other + 1];
+    char formats[xstruct_type_other + 1][XSTRUCT_PRINT_LENGTH];
+} xstruct_formatter;
+
+XDATA_FUNC void *xstruct_alloc(const xstruct_allocator *allocator, size_t size);
+XDATA_FUNC void *xstruct_alloc_aligned(size_t size);
+XDATA_FUNC void xstruct_free_aligned(void *block);
+XDATA_FUNC void *xstruct_arena_alloc(xstruct_arena *arena, size_t size);
+XDATA_FUNC void xstruct_arena_reset(xstruct_arena *arena);
+XDATA_FUNC void xstruct_arena_free(xstruct_arena *arena);
+XDATA_FUNC xstruct_arena *xstruct_arena_local(void);
+XDATA_FUNC xstruct_allocator xstruct_arena_allocator(xstruct_arena *arena);
+XDATA_FUNC const char *xstruct_format(char *typestr);
+XDATA_FUNC void xstruct_reverse(void *dst, const void *src, size_t size);
+XDATA_FUNC void xstruct_formatter_init(xstruct_formatter *formatter, const char *format);
+XDATA_FUNC const char *xstruct_formatter_get(xstruct_formatter *formatter, xstruct_type type);
+XDATA_FUNC int xstruct_print_value(FILE *file, char *buf, size_t cap, const char *formatter,
+        const char *name, xstruct_type type, void *member);
+XDATA_FUNC int xstruct_pattern_init(xstruct_pattern *pattern, char *text);
+XDATA_FUNC const char *xstruct_find(const char *s, size_t len, const char *needle, size_t needle_length);
+XDATA_FUNC int xstruct_parse_value(const char *s, size_t len, xstruct_type type, void *member);
+XDATA_FUNC uint64_t xstruct_hash_bytes(const void *data, size_t size);
+XDATA_FUNC size_t xstruct_varint_put(unsigned char *out, uint64_t value);
+XDATA_FUNC size_t xstruct_varint_get(const unsigned char *in, size_t size, uint64_t *value);
+XDATA_FUNC int xstruct_cmp_value(xstruct_type type, const void *a, const void *b, size_t size);
+XDATA_FUNC size_t xstruct_dtype(const xstruct_field *field, char *buf, size_t cap);
+XDATA_FUNC size_t xstruct_schema_json(const xstruct_schema *schema, char *buf, size_t cap);
+XDATA_FUNC void xstruct_seqlock_write(atomic_uint *sequence, atomic_uintptr_t *words,
+        const void *data, size_t size);
+XDATA_FUNC void xstruct_seqlock_read(const atomic_uint *sequence, const atomic_uintptr_t *words,
+        uintptr_t *copy, void *data, const xstruct_range *ranges, int count);
+
+#ifdef XDATA_OWNER
+// Everything in this block should only show up in a single compilation unit.
+
+// Create the array of format strings.
+// Example:
+//  const char *xstruct_formats[] = { "d", "d", "d", "u", ..., "p" };
+#define XSTRUCT_TYPE_FORMAT(type, format, tag) #format,
+XDATA_STATIC const char *xstruct_formats[] = {
+    XTYPES(XSTRUCT_TYPE_FORMAT)
+    "p"
+};
+#undef XSTRUCT_TYPE_FORMAT
+
+// Retrieves the printf format string associated with the given type string.
+#define XSTRUCT_TYPE_CMP(type, format, tag)     \
+    if (strcmp(#type, typestr) == 0) {          \
+        return #format;                         \
+    }
+XDATA_FUNC const char *xstruct_format(char *typestr) {
+    XTYPES(XSTRUCT_TYPE_CMP)
+    return "p";
+}
+#undef XSTRUCT_TYPE_CMP
+
+// Start expanding the format string, which works like the one passed to
+// print_member().
+XDATA_FUNC void xstruct_formatter_init(xstruct_formatter *formatter, const char *format) {
+    formatter->format = format;
+    memset(formatter->states, 0, sizeof(formatter->states));
+}
+
+// Get the format string expanded for the type, or NULL if it doesn't fit in
+// XSTRUCT_PRINT_LENGTH or snprintf() rejects it.
+XDATA_FUNC const char *xstruct_formatter_get(xstruct_formatter *formatter, xstruct_type type) {
+    int length;
+    if (formatter->states[type] == 0) {
+        length = snprintf(formatter->formats[type], XSTRUCT_PRINT_LENGTH,
+                formatter->format, xstruct_formats[type]);
+        formatter->states[type] = length >= 0 && length < XSTRUCT_PRINT_LENGTH ? 1 : -1;
+    }
+    return formatter->states[type] > 0 ? formatter->formats[type] : NULL;
+}
+
+// Print a member's name and value according to its type, using a format
+// string from xstruct_formatter_get(). Writes to the file if there is one,
+// and otherwise to the buffer with snprintf() semantics. Either way, it
+// returns the length of the output, or -1 if there was an error.
+#define XSTRUCT_PRINT_VALUE(value)                                              \
+    return file ? fprintf(file, formatter, name, value) :                       \
+            snprintf(buf, cap, formatter, name, value);
+#define XSTRUCT_PRINT_TYPE(type, format, tag)                                   \
+    case XSTRUCT_GLUE(xstruct_type, tag):                                       \
+        XSTRUCT_PRINT_VALUE(*(type *)member)
+XDATA_FUNC int xstruct_print_value(FILE *file, char *buf, size_t cap, const char *formatter,
+        const char *name, xstruct_type type, void *member) {
+    switch (type) {
+        XTYPES(XSTRUCT_PRINT_TYPE)
+        default:
+            XSTRUCT_PRINT_VALUE(member)
+    }
+}
+#undef XSTRUCT_PRINT_TYPE
+#undef XSTRUCT_PRINT_VALUE
+
+// Copy the given number of bytes in reverse order.
+XDATA_FUNC void xstruct_reverse(void *dst, const void *src, size_t size) {
+    unsigned char *d = dst;
+    const unsigned char *s = src;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        d[i] = s[size - 1 - i];
+    }
+}
+
+// Split a format string, already expanded with "s" as the value's conversion,
+// into the text around its two "%s" conversions. The pieces are unescaped in
+// place and point into the text. Returns -1 unless there are exactly two.
+XDATA_FUNC int xstruct_pattern_init(xstruct_pattern *pattern, char *text) {
+    const char *pieces[3];
+    size_t lengths[3];
+    char *read = text;
+    char *write = text;
+    int piece = 0;
+    pieces[0] = write;
+    while (*read) {
+        if (read[0] == '%' && read[1] == '%') {
+            *write++ = '%';
+            read += 2;
+        } else if (read[0] == '%' && read[1] == 's') {
+            if (piece == 2) {
+                return -1;
+            }
+            lengths[piece] = write - pieces[piece];
+            pieces[++piece] = write;
+            read += 2;
+        } else {
+            *write++ = *read++;
+        }
+    }
+    if (piece != 2) {
+        return -1;
+    }
+    lengths[2] = write - pieces[2];
+    pattern->lead = pieces[0];
+    pattern->lead_length = lengths[0];
+    pattern->mid = pieces[1];
+    pattern->mid_length = lengths[1];
+    pattern->tail = pieces[2];
+    pattern->tail_length = lengths[2];
+    return 0;
+}
+
+// Find the first occurrence of the needle in the first len characters of the
+// string, or NULL if there is none. An empty needle matches immediately.
+XDATA_FUNC const char *xstruct_find(const char *s, size_t len, const char *needle, size_t needle_length) {
+    const char *end = s + len;
+    if (needle_length == 0) {
+        return s;
+    }
+    while ((size_t)(end - s) >= needle_length) {
+        s = memchr(s, needle[0], end - s - needle_length + 1);
+        if (s == NULL) {
+            return NULL;
+        }
+        if (memcmp(s, needle, needle_length) == 0) {
+            return s;
+        }
+        s++;
+    }
+    return NULL;
+}
+
+// Parse an optionally signed decimal integer spanning the whole string.
+// Returns -1 if it's malformed or doesn't fit in 64 bits.
+static int xstruct_parse_integer(const char *s, size_t len, int *negative,
+        unsigned long long *value) {
+    size_t i = 0;
+    *negative = 0;
+    *value = 0;
+    if (i < len && (s[i] == '-' || s[i] == '+')) {
+        *negative = s[i++] == '-';
+    }
+    if (i == len) {
+        return -1;
+    }
+    for (; i < len; i++) {
+        unsigned int digit = (unsigned char)s[i] - '0';
+        if (digit > 9 || *value > (~0ULL - digit) / 10) {
+            return -1;
+        }
+        *value = *value * 10 + digit;
+    }
+    return 0;
+}
+
+// Parse a floating point number spanning the whole string. Plain decimals with
+// few enough digits are converted exactly with a single division, which is
+// correctly rounded; anything else goes through strtod() and friends.
+static int xstruct_parse_float(const char *s, size_t len, void *member, size_t size) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    unsigned long long mantissa = 0;
+    int negative = 0, digits = 0, decimals = -1;
+    size_t i = 0;
+    char *end;
+    if (len > XSTRUCT_PARSE_LENGTH) {
+        return -1;
+    }
+    char copy[len + 1];
+    if (i < len && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i++] == '-';
+    }
+    for (; i < len; i++) {
+        if (s[i] == '.' && decimals < 0) {
+            decimals = 0;
+        } else if (s[i] >= '0' && s[i] <= '9' && digits < 19) {
+            mantissa = mantissa * 10 + (s[i] - '0');
+            digits++;
+            decimals += decimals >= 0;
+        } else {
+            break;
+        }
+    }
+    decimals = decimals < 0 ? 0 : decimals;
+    if (i == len && digits > 0) {
+        if (size == sizeof(float) && mantissa <= 1ULL << 24 && decimals <= 10) {
+            float value = (float)mantissa / (float)powers[decimals];
+            value = negative ? -value : value;
+            memcpy(member, &value, size);
+            return 0;
+        }
+        if (size == sizeof(double) && mantissa <= 1ULL << 53 && decimals <= 22) {
+            double value = (double)mantissa / powers[decimals];
+            value = negative ? -value : value;
+            memcpy(member, &value, size);
+            return 0;
+        }
+    }
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    if (size == sizeof(float)) {
+        float value = strtof(copy, &end);
+        memcpy(member, &value, size);
+    } else if (size == sizeof(double)) {
+        double value = strtod(copy, &end);
+        memcpy(member, &value, size);
+    } else if (size == sizeof(long double)) {
+        long double value = strtold(copy, &end);
+        memcpy(member, &value, size);
+    } else {
+        return -1;
+    }
+    return len > 0 && end == copy + len ? 0 : -1;
+}
+
+// Store an integer into a member of the given size, checking that it fits.
+static int xstruct_store_integer(void *member, size_t size, int is_signed,
+        int negative, unsigned long long value) {
+    unsigned long long limit;
+    int8_t i8;
+    int16_t i16;
+    int32_t i32;
+    int64_t i64;
+    if (size == 0 || size > 8) {
+        return -1;
+    }
+    limit = ~0ULL >> (64 - 8 * size) >> is_signed;
+    negative = negative && value != 0;
+    if (negative ? !is_signed || value > limit + 1 : value > limit) {
+        return -1;
+    }
+    i64 = negative ? (int64_t)(0 - value) : (int64_t)value;
+    switch (size) {
+        case 1: i8 = (int8_t)i64; memcpy(member, &i8, 1); return 0;
+        case 2: i16 = (int16_t)i64; memcpy(member, &i16, 2); return 0;
+        case 4: i32 = (int32_t)i64; memcpy(member, &i32, 4); return 0;
+        case 8: memcpy(member, &i64, 8); return 0;
+    }
+    return -1;
+}
+
+// Parse the text of a value printed by print_value() into the member, picking
+// the parser from the type's printf conversion. Strings and pointers can't be
+// read back, so they're left untouched. Returns -1 if the value is malformed
+// or out of range.
+#define XSTRUCT_SIZE_TYPE(type, format, tag) sizeof(type),
+XDATA_FUNC int xstruct_parse_value(const char *s, size_t len, xstruct_type type, void *member) {
+    static const size_t sizes[] = { XTYPES(XSTRUCT_SIZE_TYPE) 0 };
+    const char *format = xstruct_formats[type];
+    char conversion = format[strlen(format) - 1];
+    unsigned long long value;
+    int negative;
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'u':
+            if (xstruct_parse_integer(s, len, &negative, &value) < 0) {
+                return -1;
+            }
+            if (type == xstruct_type_bool) {
+                if (negative || value > 1) {
+                    return -1;
+                }
+                *(_Bool *)member = value;
+                return 0;
+            }
+            return xstruct_store_integer(member, sizes[type], conversion != 'u',
+                    negative, value);
+        case 'f':
+        case 'e':
+        case 'g':
+            return xstruct_parse_float(s, len, member, sizes[type]);
+    }
+    return 0;
+}
+#undef XSTRUCT_SIZE_TYPE
+
+// Write a number as LEB128: seven bits per byte, low bits first, with the top
+// bit set on every byte but the last. Returns the number of bytes written, at
+// most XSTRUCT_VARINT_MAX.
+XDATA_FUNC size_t xstruct_varint_put(unsigned char *out, uint64_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (unsigned char)value;
+    return size;
+}
+
+// Read a LEB128 number from at most size bytes. Returns the number of bytes
+// read, or 0 if the number is truncated or too long.
+XDATA_FUNC size_t xstruct_varint_get(const unsigned char *in, size_t size, uint64_t *value) {
+    size_t i;
+    *value = 0;
+    for (i = 0; i < size && i < XSTRUCT_VARINT_MAX; i++) {
+        *value |= (uint64_t)(in[i] & 0x7F) << (i * 7);
+        if (!(in[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Hash bytes eight at a time, multiplying each word into the state and
+// mixing the result like MurmurHash3's finalizer. Words are loaded in host
+// byte order, so hashes are only stable on the same kind of machine.
+XDATA_FUNC uint64_t xstruct_hash_bytes(const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    uint64_t hash = 0x9E3779B97F4A7C15u ^ size;
+    uint64_t word;
+    size_t i;
+    for (i = 0; i + 8 <= size; i += 8) {
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9u;
+        hash ^= hash >> 29;
+    }
+    if (i < size) {
+        word = 0;
+        memcpy(&word, bytes + i, size - i);
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9u;
+        hash ^= hash >> 29;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDu;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53u;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Order two strings by content, with NULL before any string.
+static int xstruct_cmp_str(const char *a, const char *b) {
+    int result;
+    if (a == NULL || b == NULL) {
+        return (a != NULL) - (b != NULL);
+    }
+    result = strcmp(a, b);
+    return (result > 0) - (result < 0);
+}
+
+// Order two members of the given type by value. Strings compare by content,
+// and NaNs sort after every number. Ties, like equal strings at different
+// addresses or two NaNs, are broken by the value's bytes, so the result is
+// zero exactly when the members are equal byte for byte, and sorting with it
+// is well defined.
+#define XSTRUCT_CMP_TYPE(type, format, tag)                                     \
+    case XSTRUCT_GLUE(xstruct_type, tag): {                                     \
+        type x;                                                                 \
+        type y;                                                                 \
+        if (XSTRUCT_GLUE(xstruct_type, tag) == xstruct_type_str ||              \
+                XSTRUCT_GLUE(xstruct_type, tag) == xstruct_type_cstr) {         \
+            result = xstruct_cmp_str(*(const char *const *)a,                   \
+                    *(const char *const *)b);                                   \
+            if (result != 0) {                                                  \
+                return result;                                                  \
+            }                                                                   \
+            break;                                                              \
+        }                                                                       \
+        memcpy(&x, a, sizeof(x));                                               \
+        memcpy(&y, b, sizeof(y));                                               \
+        if (x != x || y != y) {                                                 \
+            if (x == x) {                                                       \
+                return -1;                                                      \
+            }                                                                   \
+            if (y == y) {                                                       \
+                return 1;                                                       \
+            }                                                                   \
+            break;                                                              \
+        }                                                                       \
+        if (x < y) {                                                            \
+            return -1;                                                          \
+        }                                                                       \
+        if (x > y) {                                                            \
+            return 1;                                                           \
+        }                                                                       \
+        break;                                                                  \
+    }
+XDATA_FUNC int xstruct_cmp_value(xstruct_type type, const void *a, const void *b, size_t size) {
+    int result;
+    switch (type) {
+        XTYPES(XSTRUCT_CMP_TYPE)
+        default:
+            break;
+    }
+    result = memcmp(a, b, XSTRUCT_VALUE_SIZE_OF(type, size));
+    return (result > 0) - (result < 0);
+}
+#undef XSTRUCT_CMP_TYPE
+
+// Write a member's numpy type string into the buffer, with snprintf()
+// semantics. Integers and floats get their kind from the last character of
+// their printf format, and anything else, pointers and strings included, is
+// left as opaque bytes.
+// Example:
+//  "<i4" for int, "<f8" for double, "|b1" for _Bool, "|V8" for color *
+XDATA_FUNC size_t xstruct_dtype(const xstruct_field *field, char *buf, size_t cap) {
+    const char *format = xstruct_formats[field->tag];
+    char kind = format[strlen(format) - 1];
+    int written;
+    if (field->tag == xstruct_type_bool) {
+        kind = 'b';
+    } else if (kind == 'd') {
+        kind = 'i';
+    } else if (kind != 'u' && kind != 'f') {
+        kind = 'V';
+    }
+    written = snprintf(buf, cap, "%c%c%zu",
+            field->size == 1 || kind == 'V' ? '|' : XSTRUCT_BYTE_ORDER, kind, field->size);
+    return written > 0 ? (size_t)written : 0;
+}
+
+// Write the schema into the buffer as compact JSON, with snprintf() semantics.
+// Each field is listed as the schema has it, and "dtype" holds a numpy dtype
+// spec, so numpy.dtype(json.load(f)["dtype"]) can view raw arrays of the
+// struct in place. Names and types are C identifiers and type names, so they
+// never need escaping.
+// Example:
+//  {"name":"pixel","size":24,"align":8,"fields":[{"name":"x","type":"int",
+//  "offset":0,"size":4,"group":0,"dtype":"<i4"},...],"dtype":{"names":["x",
+//  ...],"formats":["<i4",...],"offsets":[0,...],"itemsize":24}}
+#define XSTRUCT_JSON(...)                                                       \
+    written = snprintf(length < cap ? buf + length : NULL,                      \
+            length < cap ? cap - length : 0, __VA_ARGS__);                      \
+    length += written > 0 ? (size_t)written : 0;
+XDATA_FUNC size_t xstruct_schema_json(const xstruct_schema *schema, char *buf, size_t cap) {
+    const xstruct_field *field;
+    char dtype[32];
+    size_t length = 0;
+    int i, written;
+    XSTRUCT_JSON("{\"name\":\"%s\",\"size\":%zu,\"align\":%zu,\"fields\":[",
+            schema->name, schema->size, schema->align);
+    for (i = 0; i < schema->count; i++) {
+        field = &schema->fields[i];
+        xstruct_dtype(field, dtype, sizeof(dtype));
+        XSTRUCT_JSON("%s{\"name\":\"%s\",\"type\":\"%s\",\"offset\":%zu,\"size\":%zu,"
+                "\"group\":%d,\"dtype\":\"%s\"}", i > 0 ? "," : "", field->name,
+                field->type, field->offset, field->size, field->group, dtype);
+    }
+    XSTRUCT_JSON("],\"dtype\":{\"names\":[");
+    for (i = 0; i < schema->count; i++) {
+        XSTRUCT_JSON("%s\"%s\"", i > 0 ? "," : "", schema->fields[i].name);
+    }
+    XSTRUCT_JSON("],\"formats\":[");
+    for (i = 0; i < schema->count; i++) {
+        xstruct_dtype(&schema->fields[i], dtype, sizeof(dtype));
+        XSTRUCT_JSON("%s\"%s\"", i > 0 ? "," : "", dtype);
+    }
+    XSTRUCT_JSON("],\"offsets\":[");
+    for (i = 0; i < schema->count; i++) {
+        XSTRUCT_JSON("%s%zu", i > 0 ? "," : "", schema->fields[i].offset);
+    }
+    XSTRUCT_JSON("],\"itemsize\":%zu}}", schema->size);
+    return length;
+}
+#undef XSTRUCT_JSON
+
+// Store data into words guarded by a sequence lock. The sequence is odd while
+// the words are being written, and each word is stored with a relaxed atomic,
+// so readers never see a torn word and can tell when to retry. Only one
+// writer may store at a time.
+XDATA_FUNC void xstruct_seqlock_write(atomic_uint *sequence, atomic_uintptr_t *words,
+        const void *data, size_t size) {
+    unsigned int start = atomic_load_explicit(sequence, memory_order_relaxed);
+    uintptr_t word;
+    size_t i, n;
+    atomic_store_explicit(sequence, start + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (i = 0; i < size; i += sizeof(word)) {
+        n = size - i < sizeof(word) ? size - i : sizeof(word);
+        word = 0;
+        memcpy(&word, (const char *)data + i, n);
+        atomic_store_explicit(&words[i / sizeof(word)], word, memory_order_relaxed);
+    }
+    atomic_store_explicit(sequence, start + 2, memory_order_release);
+}
+
+// Load the words covering each range into copy, which is indexed like words,
+// until a pass finds the sequence even and unchanged, then copy the ranges out
+// of it into data. Readers never write to the lock, so they don't slow the
+// writer or each other.
+XDATA_FUNC void xstruct_seqlock_read(const atomic_uint *sequence, const atomic_uintptr_t *words,
+        uintptr_t *copy, void *data, const xstruct_range *ranges, int count) {
+    unsigned int start, spins = 0;
+    size_t w, last;
+    int i;
+    do {
+        start = atomic_load_explicit(sequence, memory_order_acquire);
+        if (start & 1) {
+            if (++spins % XSTRUCT_SEQLOCK_SPINS == 0) {
+                XSTRUCT_YIELD();
+            }
+            continue;
+        }
+        for (i = 0; i < count; i++) {
+            last = (ranges[i].offset + ranges[i].size - 1) / sizeof(uintptr_t);
+            for (w = ranges[i].offset / sizeof(uintptr_t); w <= last; w++) {
+                copy[w] = atomic_load_explicit(&words[w], memory_order_relaxed);
+            }
+        }
+        atomic_thread_fence(memory_order_acquire);
+    } while ((start & 1) || atomic_load_explicit(sequence, memory_order_relaxed) != start);
+    for (i = 0; i < count; i++) {
+        memcpy((char *)data + ranges[i].offset, (char *)copy + ranges[i].offset,
+                ranges[i].size);
+    }
+}
+
+// Allocate memory with the given allocator, or with XDATA_ALLOC if it's NULL.
+XDATA_FUNC void *xstruct_alloc(const xstruct_allocator *allocator, size_t size) {
+    if (allocator == NULL) {
+        return XDATA_ALLOC(size);
+    }
+    return allocator->alloc(allocator->context, size);
+}
+
+// Allocate memory aligned to XSTRUCT_SOA_ALIGN with XDATA_ALLOC, or return
+// NULL. The pointer XDATA_ALLOC returned is kept just before the block, for
+// xstruct_free_aligned() to pass to XDATA_FREE.
+XDATA_FUNC void *xstruct_alloc_aligned(size_t size) {
+    size_t extra = XSTRUCT_SOA_ALIGN - 1 + sizeof(void *);
+    void *raw;
+    char *block;
+    if (size > SIZE_MAX - extra) {
+        return NULL;
+    }
+    raw = XDATA_ALLOC(size + extra);
+    if (raw == NULL) {
+        return NULL;
+    }
+    block = (char *)raw + sizeof(void *);
+    block += (XSTRUCT_SOA_ALIGN - (uintptr_t)block % XSTRUCT_SOA_ALIGN) % XSTRUCT_SOA_ALIGN;
+    memcpy(block - sizeof(void *), &raw, sizeof(raw));
+    return block;
+}
+
+// Free memory from xstruct_alloc_aligned(). Does nothing for NULL.
+XDATA_FUNC void xstruct_free_aligned(void *block) {
+    void *raw;
+    if (block != NULL) {
+        memcpy(&raw, (char *)block - sizeof(void *), sizeof(raw));
+        XDATA_FREE(raw);
+    }
+}
+
+// Allocate memory from the arena, adding a block twice as large as the last
+// one when it runs out. Returns NULL if that allocation fails, or if the size
+// is too large to round up and place after a block header.
+XDATA_FUNC void *xstruct_arena_alloc(xstruct_arena *arena, size_t size) {
+    xstruct_arena_block *block = arena->blocks;
+    size_t header = XSTRUCT_ARENA_ROUND(sizeof(xstruct_arena_block));
+    if (size > SIZE_MAX - header - _Alignof(max_align_t)) {
+        return NULL;
+    }
+    size = XSTRUCT_ARENA_ROUND(size);
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = arena->block_size ? arena->block_size : XSTRUCT_ARENA_BLOCK;
+        if (block != NULL && block->size <= (SIZE_MAX - header) / 2 &&
+                block_size < block->size * 2) {
+            block_size = block->size * 2;
+        }
+        if (block_size < size) {
+            block_size = size;
+        }
+        if (block_size > SIZE_MAX - header) {
+            return NULL;
+        }
+        block = XDATA_ALLOC(header + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = arena->blocks;
+        block->size = block_size;
+        block->used = 0;
+        arena->blocks = block;
+    }
+    block->used += size;
+    return (char *)block + header + block->used - size;
+}
+
+// Release everything allocated from the arena. The newest, largest block is
+// kept, so an arena that's reset after each batch of work soon stops
+// allocating at all.
+XDATA_FUNC void xstruct_arena_reset(xstruct_arena *arena) {
+    xstruct_arena_block *block = arena->blocks, *next;
+    if (block == NULL) {
+        return;
+    }
+    for (next = block->next; next != NULL; next = block->next) {
+        block->next = next->next;
+        XDATA_FREE(next);
+    }
+    block->used = 0;
+}
+
+// Release the arena's memory, leaving it empty.
+XDATA_FUNC void xstruct_arena_free(xstruct_arena *arena) {
+    xstruct_arena_block *block, *next;
+    for (block = arena->blocks; block != NULL; block = next) {
+        next = block->next;
+        XDATA_FREE(block);
+    }
+    arena->blocks = NULL;
+}
+
+// Get the calling thread's own arena, for use without any locking. Threads
+// should xstruct_arena_free() it before exiting.
+XDATA_FUNC xstruct_arena *xstruct_arena_local(void) {
+    static _Thread_local xstruct_arena arena;
+    return &arena;
+}
+
+static void *xstruct_arena_alloc_with(void *context, size_t size) {
+    return xstruct_arena_alloc(context, size);
+}
+
+static void xstruct_arena_free_with(void *context, void *ptr) {
+    (void)context;
+    (void)ptr;
+}
+
+// Get an allocator that draws from the arena. Its free() does nothing; reset
+// the arena instead.
+// Example:
+//  xstruct_allocator allocator = xstruct_arena_allocator(xstruct_arena_local());
+//  char *str = pixel_print_with(&p, "%%s = %%%s", "; ", &allocator);
+XDATA_FUNC xstruct_allocator xstruct_arena_allocator(xstruct_arena *arena) {
+    xstruct_allocator allocator = {
+        xstruct_arena_alloc_with, xstruct_arena_free_with, arena
+    };
+    return allocator;
+}
+
+#endif // XDATA_OWNER
+
+#endif // XSTRUCT_H_
+
+// Everything below this point runs once per struct. Refer to struct.pixel.h
+// for the examples in the comments, as well as enum.pixelgroup.h for those
+// that deal with groups.
+
+////////// Static data structure declarations.
+
+// Create the struct for this macro.
+// Example:
+//  typedef struct pixel { int x; int y; color *color; float alpha; }
+#define X(type, identifier) type identifier;
+typedef struct XNAME {
+    #include XSTRUCT_FILE(XNAME)
+} XNAME;
+#undef X
+
+// Create the enum for this macro's members.
+// enum { pixel_member_x, pixel_member_y, pixel_member_color, pixel_member_alpha, pixel_members };
+#define X(type, identifier) XSTRUCT_GLUE(XSTRUCT_GLUE(XNAME, member), identifier),
+typedef enum {
+    #include XSTRUCT_FILE(XNAME)
+    XSTRUCT_GLUE(XNAME, members)
+} XSTRUCT_GLUE(XNAME, enum);
+#undef X
+
+// Create a table of typed callbacks, one per member, for visit(). Each one gets
+// a pointer to the member with its real type.
+// Example:
+//  typedef struct pixel_visitor { int (*x)(int *, void *); int (*y)(int *, void *);
+//          int (*color)(color **, void *); int (*alpha)(float *, void *); } pixel_visitor;
+#define X(type, identifier) int (*identifier)(type *member, void *context);
+typedef struct XSTRUCT_GLUE(XNAME, visitor) {
+    #include XSTRUCT_FILE(XNAME)
+} XSTRUCT_GLUE(XNAME, visitor);
+#undef X
+
+// Call the visitor's callback for each member, skipping NULL callbacks, until
+// one returns nonzero. This is defined in the header so that when the visitor
+// is a constant, the compiler can inline the callbacks.
+// Example:
+//  static inline void pixel_visit(pixel *structure, const pixel_visitor *visitor, void *context) { ... }
+#define X(type, identifier)                                                     \
+    if (visitor->identifier && visitor->identifier(&structure->identifier, context)) { \
+        return;                                                                 \
+    }
+static inline void XSTRUCT_GLUE(XNAME, visit)(XNAME *structure,
+        const XSTRUCT_GLUE(XNAME, visitor) *visitor, void *context) {
+    #include XSTRUCT_FILE(XNAME)
+}
+#undef X
+
+#if XGROUP
+
+// Find the lowest and highest groups at compile time, the same way xenum.h
+// finds its lowest and highest values. Every group in between gets a slot in
+// the group index, so groups should be dense.
+// Example:
+//  enum { pixel_group_lowest = 0, pixel_group_highest = 1, pixel_group_slots = 2 };
+#define X(type, identifier) char identifier
+#undef GROUP
+enum {
+    #define GROUP(g) [XENUM_BIAS - (long long)(g)];
+    XSTRUCT_GLUE(XNAME, group_lowest) = (int)(XENUM_BIAS - (long long)sizeof(union {
+        #include XSTRUCT_FILE(XNAME)
+    })),
+    #undef GROUP
+    #define GROUP(g) [(long long)(g) + XENUM_BIAS + 1];
+    XSTRUCT_GLUE(XNAME, group_highest) = (int)((long long)sizeof(union {
+        #include XSTRUCT_FILE(XNAME)
+    }) - XENUM_BIAS - 1),
+    #undef GROUP
+    XSTRUCT_GLUE(XNAME, group_slots) = XSTRUCT_GLUE(XNAME, group_highest) -
+            XSTRUCT_GLUE(XNAME, group_lowest) + 1
+};
+#define GROUP(g)
+#undef X
+
+#endif // XGROUP
+
+#if XSOA
+
+// Create a struct of arrays with one aligned column per member, which share a
+// single allocation. Zero-initialize it before use. The length, capacity and
+// columns fields are reserved, so members can't use those names.
+// Example:
+//  typedef struct pixel_soa { int *x; int *y; color **color; float *alpha;
+//          size_t length; size_t capacity; void *columns; } pixel_soa;
+#define X(type, identifier) type *identifier;
+typedef struct XSTRUCT_GLUE(XNAME, soa) {
+    #include XSTRUCT_FILE(XNAME)
+    size_t length;
+    size_t capacity;
+    void *columns;
+} XSTRUCT_GLUE(XNAME, soa);
+#undef X
+
+#endif // XSOA
+
+// Create a struct describing the serialized form: each member's bytes in
+// little-endian order, back to back. Char arrays need no alignment, so there's
+// no padding, and a file of records can be mapped and read in place.
+// Example:
+//  typedef struct pixel_record { unsigned char x[4]; unsigned char y[4];
+//          unsigned char color[8]; unsigned char alpha[4]; } pixel_record;
+#define X(type, identifier) unsigned char identifier[sizeof(type)];
+typedef struct XSTRUCT_GLUE(XNAME, record) {
+    #include XSTRUCT_FILE(XNAME)
+} XSTRUCT_GLUE(XNAME, record);
+#undef X
+
+#define X(type, identifier) + sizeof(type)
+_Static_assert(sizeof(XSTRUCT_GLUE(XNAME, record)) == 0
+    #include XSTRUCT_FILE(XNAME)
+    , "serialized records must not contain padding");
+#undef X
+
+// Describe the struct's layout at compile time: the bytes lost to padding, the
+// cache lines it spans when it starts on a line boundary, and its size with the
+// members sorted by alignment, largest first, which leaves padding only at the
+// end. Every type's size is a multiple of its alignment, so that's the packed
+// size rounded up to the struct's alignment.
+// Example:
+//  enum { pixel_padding = 4, pixel_cache_lines = 1, pixel_reordered_size = 24 };
+enum {
+    XSTRUCT_GLUE(XNAME, padding) = sizeof(XNAME) - sizeof(XSTRUCT_GLUE(XNAME, record)),
+    XSTRUCT_GLUE(XNAME, cache_lines) = (sizeof(XNAME) + XSTRUCT_CACHE_LINE - 1) /
+            XSTRUCT_CACHE_LINE,
+    XSTRUCT_GLUE(XNAME, reordered_size) = (sizeof(XSTRUCT_GLUE(XNAME, record)) +
+            _Alignof(XNAME) - 1) / _Alignof(XNAME) * _Alignof(XNAME)
+};
+
+// Create a bitmask with one bit per member, by index, for diff(). A delta
+// starts with the same bits packed into bytes, followed by the changed
+// members, so the largest one is a full record plus the mask.
+// Example:
+//  enum { pixel_mask_words = 1, pixel_delta_max = 21 };
+//  typedef struct pixel_mask { uint64_t words[1]; } pixel_mask;
+enum {
+    XSTRUCT_GLUE(XNAME, mask_words) = (XSTRUCT_GLUE(XNAME, members) + 63) / 64,
+    XSTRUCT_GLUE(XNAME, delta_max) = (XSTRUCT_GLUE(XNAME, members) + 7) / 8 +
+            sizeof(XSTRUCT_GLUE(XNAME, record))
+};
+typedef struct XSTRUCT_GLUE(XNAME, mask) {
+    uint64_t words[XSTRUCT_GLUE(XNAME, mask_words)];
+} XSTRUCT_GLUE(XNAME, mask);
+
+// Create a copy of the struct for one writer thread to share with any number
+// of readers, guarded by a sequence lock. It's held as machine words so each
+// one can be copied with a relaxed atomic. A zeroed one holds a zeroed struct.
+// Example:
+//  enum { pixel_shared_words = 3 };
+//  typedef struct pixel_shared { atomic_uint sequence; atomic_uintptr_t words[3]; } pixel_shared;
+enum {
+    XSTRUCT_GLUE(XNAME, shared_words) = (sizeof(XNAME) + sizeof(uintptr_t) - 1) /
+            sizeof(uintptr_t)
+};
+typedef struct XSTRUCT_GLUE(XNAME, shared) {
+    atomic_uint sequence;
+    atomic_uintptr_t words[XSTRUCT_GLUE(XNAME, shared_words)];
+} XSTRUCT_GLUE(XNAME, shared);
+
+#if XPACKED
+
+// Create a copy of the struct with the same members in the same order, but
+// no padding, so arrays of it fit more structs per cache line. Members may be
+// misaligned, which costs a little on most targets, and taking their address
+// as a typed pointer isn't safe; use pack() and unpack() to work on them.
+// Example:
+//  #pragma pack(push, 1)
+//  typedef struct pixel_packed { int x; int y; color *color; float alpha; } pixel_packed;
+//  #pragma pack(pop)
+#define X(type, identifier) type identifier;
+#pragma pack(push, 1)
+typedef struct XSTRUCT_GLUE(XNAME, packed) {
+    #include XSTRUCT_FILE(XNAME)
+} XSTRUCT_GLUE(XNAME, packed);
+#pragma pack(pop)
+#undef X
+
+_Static_assert(sizeof(XSTRUCT_GLUE(XNAME, packed)) == sizeof(XSTRUCT_GLUE(XNAME, record)),
+        "packed structs must not contain padding");
+
+#endif // XPACKED
+
+// Create an open-addressing hash map from structs to values of a fixed size.
+// Tags, keys and values live in three flat arrays sharing one allocation, and
+// collisions probe linearly through the tags, which hold 31 bits of each key's
+// hash and mark empty slots with zero. Set it up with pixel_map_init().
+// Example:
+//  typedef struct pixel_map { uint32_t *tags; pixel *keys; unsigned char *values;
+//          size_t value_size; size_t length; size_t capacity; } pixel_map;
+typedef struct XSTRUCT_GLUE(XNAME, map) {
+    uint32_t *tags;
+    XNAME *keys;
+    unsigned char *values;
+    size_t value_size;
+    size_t length;
+    size_t capacity;
+} XSTRUCT_GLUE(XNAME, map);
+
+// Lay out the string pools of member names and of their types like the enum
+// string pools. Only the types are used.
+// Example:
+//  struct pixel_str_layout { char x[2]; char y[2]; char color[6]; char alpha[6]; };
+//  struct pixel_type_str_layout { char x[4]; char y[4]; char color[8]; char alpha[6]; };
+#define X(type, identifier) char identifier[sizeof(#identifier)];
+struct XSTRUCT_GLUE(XNAME, str_layout) {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+#define X(type, identifier) char identifier[sizeof(#type)];
+struct XSTRUCT_GLUE(XNAME, type_str_layout) {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Holds the string name of each member in one pool of characters, and the
+// offset of each name in it, like the enum string pools.
+// Example:
+//  const char pixel_str_pool[16];
+//  const uint32_t pixel_str_offsets[4];
+XDATA_EXTERN const char XSTRUCT_GLUE(XNAME, str_pool)[sizeof(struct XSTRUCT_GLUE(XNAME, str_layout))];
+XDATA_EXTERN const uint32_t XSTRUCT_GLUE(XNAME, str_offsets)[XSTRUCT_GLUE(XNAME, members)];
+
+// Holds the string name of each member's type the same way.
+// Example:
+//  const char pixel_type_str_pool[22];
+//  const uint32_t pixel_type_str_offsets[4];
+XDATA_EXTERN const char XSTRUCT_GLUE(XNAME, type_str_pool)[
+        sizeof(struct XSTRUCT_GLUE(XNAME, type_str_layout))];
+XDATA_EXTERN const uint32_t XSTRUCT_GLUE(XNAME, type_str_offsets)[XSTRUCT_GLUE(XNAME, members)];
+
+// Holds the type tag of each member in an array.
+// Example:
+//  const xstruct_type pixel_types[4];
+XDATA_EXTERN const xstruct_type XSTRUCT_GLUE(XNAME, types)[XSTRUCT_GLUE(XNAME, members)];
+
+// Holds the offset of each member from the start of the struct in an array.
+// Example:
+//  const size_t pixel_offsets[4];
+XDATA_EXTERN const size_t XSTRUCT_GLUE(XNAME, offsets)[XSTRUCT_GLUE(XNAME, members)];
+
+// Holds the size of each member in an array.
+// Example:
+//  const size_t pixel_sizes[4];
+XDATA_EXTERN const size_t XSTRUCT_GLUE(XNAME, sizes)[XSTRUCT_GLUE(XNAME, members)];
+
+// Holds the offset of each member within a serialized record in an array.
+// Example:
+//  const size_t pixel_record_offsets[4];
+XDATA_EXTERN const size_t XSTRUCT_GLUE(XNAME, record_offsets)[XSTRUCT_GLUE(XNAME, members)];
+
+#if XPACKED
+
+// Holds the offset of each member within a packed struct in an array.
+// Example:
+//  const size_t pixel_packed_offsets[4];
+XDATA_EXTERN const size_t XSTRUCT_GLUE(XNAME, packed_offsets)[XSTRUCT_GLUE(XNAME, members)];
+
+#endif // XPACKED
+
+#if XGROUP
+
+// Holds the group of each member in an array.
+// Example:
+//  int pixel_groups[4];
+XDATA_EXTERN int XENUM_GLUE(XNAME, groups)[XSTRUCT_GLUE(XNAME, members)];
+
+#endif // XGROUP
+
+////////// Function declarations. Refer to their definitions for documentation.
+
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, index)(XNAME *structure, void *member);
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, member)(XNAME *structure, int index);
+XDATA_FUNC const char *XSTRUCT_GLUE(XNAME, str)(XNAME *structure, void *member);
+XDATA_FUNC const char *XSTRUCT_GLUE(XNAME, type_str)(XNAME *structure, void *member);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, iter)(XNAME *structure, int callback(void *));
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print_member)(XNAME *structure, void *member, const char *format);
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print_member_with)(XNAME *structure, void *member,
+        const char *format, const xstruct_allocator *allocator);
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print)(XNAME *structure, const char *format, const char *sep);
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print_with)(XNAME *structure, const char *format,
+        const char *sep, const xstruct_allocator *allocator);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, print_to)(char *buf, size_t cap, XNAME *structure,
+        const char *format, const char *sep);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, print_size)(XNAME *structure, const char *format, const char *sep);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, fprint)(FILE *file, XNAME *structure, const char *format, const char *sep);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, fprint_layout)(FILE *file);
+XDATA_FUNC const xstruct_schema *XSTRUCT_GLUE(XNAME, schema)(void);
+
+#if XSOA
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, soa_reserve)(XSTRUCT_GLUE(XNAME, soa) *soa, size_t capacity);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_free)(XSTRUCT_GLUE(XNAME, soa) *soa);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, soa_push)(XSTRUCT_GLUE(XNAME, soa) *soa, const XNAME *structure);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_get)(const XSTRUCT_GLUE(XNAME, soa) *soa, size_t i, XNAME *structure);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_set)(XSTRUCT_GLUE(XNAME, soa) *soa, size_t i, const XNAME *structure);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, soa_from_array)(XSTRUCT_GLUE(XNAME, soa) *soa, const XNAME *array, size_t n);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_to_array)(const XSTRUCT_GLUE(XNAME, soa) *soa, XNAME *array);
+#endif
+
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, serialize)(const XNAME *structure, unsigned char *out);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, deserialize)(XNAME *structure, const unsigned char *in);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, serialize_array)(const XNAME *array, size_t n, unsigned char *out);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, deserialize_array)(XNAME *array, size_t n, const unsigned char *in);
+
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, diff)(const XNAME *a, const XNAME *b, XSTRUCT_GLUE(XNAME, mask) *mask);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_encode)(const XNAME *from, const XNAME *to, unsigned char *out);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_apply)(XNAME *structure, const unsigned char *in);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_encode_array)(const XNAME *from, const XNAME *to, size_t n,
+        unsigned char *out);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_apply_array)(XNAME *array, size_t n,
+        const unsigned char *in, size_t size);
+
+#if XPACKED
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, pack)(const XNAME *structure, XSTRUCT_GLUE(XNAME, packed) *packed);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, unpack)(const XSTRUCT_GLUE(XNAME, packed) *packed, XNAME *structure);
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, packed_member)(XSTRUCT_GLUE(XNAME, packed) *packed, int index);
+#endif
+
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, parse)(const char *s, size_t len, const char *format,
+        const char *sep, XNAME *out);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, parse_lines)(const char *s, size_t len, const char *format,
+        const char *sep, XNAME *out, size_t max);
+
+XDATA_FUNC uint64_t XSTRUCT_GLUE(XNAME, hash)(const XNAME *structure);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, equal)(const XNAME *a, const XNAME *b);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, cmp)(const XNAME *a, const XNAME *b);
+
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_init)(XSTRUCT_GLUE(XNAME, map) *map, size_t value_size);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, map_reserve)(XSTRUCT_GLUE(XNAME, map) *map, size_t count);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_free)(XSTRUCT_GLUE(XNAME, map) *map);
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, map_get)(const XSTRUCT_GLUE(XNAME, map) *map, const XNAME *key);
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, map_put)(XSTRUCT_GLUE(XNAME, map) *map, const XNAME *key);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, map_remove)(XSTRUCT_GLUE(XNAME, map) *map, const XNAME *key);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_clear)(XSTRUCT_GLUE(XNAME, map) *map);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_iter)(XSTRUCT_GLUE(XNAME, map) *map,
+        int callback(const XNAME *, void *));
+
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, shared_store)(XSTRUCT_GLUE(XNAME, shared) *shared,
+        const XNAME *structure);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, shared_load)(const XSTRUCT_GLUE(XNAME, shared) *shared,
+        XNAME *structure);
+
+#if XGROUP
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, group)(XNAME *structure, void *member);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, is_in_group)(XNAME *structure, void *member, int group);
+XDATA_FUNC const int *XSTRUCT_GLUE(XNAME, group_indices)(int group, int *count);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, group_iter)(XNAME *structure, int group, int callback(void *));
+XDATA_FUNC uint64_t XSTRUCT_GLUE(XNAME, hash_group)(const XNAME *structure, int group);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, equal_group)(const XNAME *a, const XNAME *b, int group);
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, cmp_group)(const XNAME *a, const XNAME *b, int group);
+XDATA_FUNC const xstruct_range *XSTRUCT_GLUE(XNAME, group_ranges)(int group, int *count);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, group_size)(int group);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, group_copy)(XNAME *dst, const XNAME *src, int group);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, group_gather)(const XNAME *array, size_t n, int group,
+        unsigned char *out);
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, group_scatter)(XNAME *array, size_t n, int group,
+        const unsigned char *in);
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, shared_load_group)(const XSTRUCT_GLUE(XNAME, shared) *shared,
+        XNAME *structure, int group);
+#endif
+
+#ifdef XDATA_OWNER
+// Everything in this block should only show up in a single compilation unit
+// for each enum.
+
+////////// Variable definitions.
+
+// Create the string pool of member names, and their offsets.
+// Example:
+//  const char pixel_str_pool[16] = "x\0" "y\0" "color\0" "alpha\0";
+//  const uint32_t pixel_str_offsets[] = { 0, 2, 4, 10 };
+#define X(type, identifier) #identifier "\0"
+XDATA_STATIC const char XSTRUCT_GLUE(XNAME, str_pool)[sizeof(struct XSTRUCT_GLUE(XNAME, str_layout))] =
+    #include XSTRUCT_FILE(XNAME)
+    ;
+#undef X
+#define X(type, identifier) offsetof(struct XSTRUCT_GLUE(XNAME, str_layout), identifier),
+XDATA_STATIC const uint32_t XSTRUCT_GLUE(XNAME, str_offsets)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Create the string pool of types, and their offsets.
+// Example:
+//  const char pixel_type_str_pool[22] = "int\0" "int\0" "color *\0" "float\0";
+//  const uint32_t pixel_type_str_offsets[] = { 0, 4, 8, 16 };
+#define X(type, identifier) #type "\0"
+XDATA_STATIC const char XSTRUCT_GLUE(XNAME, type_str_pool)[
+        sizeof(struct XSTRUCT_GLUE(XNAME, type_str_layout))] =
+    #include XSTRUCT_FILE(XNAME)
+    ;
+#undef X
+#define X(type, identifier) offsetof(struct XSTRUCT_GLUE(XNAME, type_str_layout), identifier),
+XDATA_STATIC const uint32_t XSTRUCT_GLUE(XNAME, type_str_offsets)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Create the array of type tags, letting _Generic match each member's type.
+// Example:
+//  const xstruct_type pixel_types[] = { xstruct_type_int, xstruct_type_int,
+//          xstruct_type_other, xstruct_type_float };
+#define X(type, identifier) XSTRUCT_TYPE(((XNAME *)0)->identifier),
+XDATA_STATIC const xstruct_type XSTRUCT_GLUE(XNAME, types)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Create the array of member offsets.
+// Example:
+//  const size_t pixel_offsets[] = { 0, 4, 8, 16 };
+#define X(type, identifier) offsetof(XNAME, identifier),
+XDATA_STATIC const size_t XSTRUCT_GLUE(XNAME, offsets)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Create the array of member sizes.
+// Example:
+//  const size_t pixel_sizes[] = { 4, 4, 8, 4 };
+#define X(type, identifier) sizeof(((XNAME *)0)->identifier),
+XDATA_STATIC const size_t XSTRUCT_GLUE(XNAME, sizes)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Create the array of member name lengths.
+// Example:
+//  static const size_t pixel_lengths[] = { 1, 1, 5, 5 };
+#define X(type, identifier) sizeof(#identifier) - 1,
+static const size_t XSTRUCT_GLUE(XNAME, lengths)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+// Create the array of offsets within a serialized record.
+// Example:
+//  const size_t pixel_record_offsets[] = { 0, 4, 8, 16 };
+#define X(type, identifier) offsetof(XSTRUCT_GLUE(XNAME, record), identifier),
+XDATA_STATIC const size_t XSTRUCT_GLUE(XNAME, record_offsets)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+#if XPACKED
+
+// Create the array of offsets within a packed struct.
+// Example:
+//  const size_t pixel_packed_offsets[] = { 0, 4, 8, 16 };
+#define X(type, identifier) offsetof(XSTRUCT_GLUE(XNAME, packed), identifier),
+XDATA_STATIC const size_t XSTRUCT_GLUE(XNAME, packed_offsets)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef X
+
+#endif // XPACKED
+
+#if XGROUP
+
+// Create the group array.
+// Example:
+//  int pixel_groups[] = { pix_pos, pix_pos, pix_other, pix_other };
+#define X(type, identifier)
+#undef GROUP
+#define GROUP(g) g,
+XDATA_STATIC int XSTRUCT_GLUE(XNAME, groups)[] = {
+    #include XSTRUCT_FILE(XNAME)
+};
+#undef GROUP
+#define GROUP(g)
+#undef X
+
+// Holds the index of every member, sorted by group, and where each group
+// starts in it, indexed by group minus the lowest group. It's filled in on
+// first use.
+// Example:
+//  static int pixel_group_offsets[3];   // { 0, 2, 4 }
+//  static int pixel_group_members[4];   // { 0, 1, 2, 3 }
+static int XSTRUCT_GLUE(XNAME, group_offsets)[XSTRUCT_GLUE(XNAME, group_slots) + 1];
+static int XSTRUCT_GLUE(XNAME, group_members)[XSTRUCT_GLUE(XNAME, members)];
+static atomic_int XSTRUCT_GLUE(XNAME, group_state);
+
+// Holds each group's members merged into runs of bytes, where members that
+// are next to each other in the struct share a run along with any padding
+// between them, and where each group's runs start, like the arrays above.
+// They're filled in on first use as well.
+// Example:
+//  static int pixel_group_range_offsets[3];         // { 0, 1, 2 }
+//  static xstruct_range pixel_group_range_list[4];  // { { 0, 8 }, { 8, 12 } }
+static int XSTRUCT_GLUE(XNAME, group_range_offsets)[XSTRUCT_GLUE(XNAME, group_slots) + 1];
+static xstruct_range XSTRUCT_GLUE(XNAME, group_range_list)[XSTRUCT_GLUE(XNAME, members)];
+
+#endif // XGROUP
+
+// Holds the schema and its fields, which point into the string pools. They're
+// filled in on first use, so the tables above stay free of relocations.
+// Example:
+//  static xstruct_field pixel_schema_fields[4];
+//  static xstruct_schema pixel_schema_table;
+static xstruct_field XSTRUCT_GLUE(XNAME, schema_fields)[XSTRUCT_GLUE(XNAME, members)];
+static xstruct_schema XSTRUCT_GLUE(XNAME, schema_table);
+static atomic_int XSTRUCT_GLUE(XNAME, schema_state);
+
+////////// Function definitions.
+
+// Get the index of the member containing the given address, or -1 for invalid
+// input. Members are laid out in order, so this binary searches the offsets.
+// Example:
+//  int pixel_index(pixel *structure, void *member) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, index)(XNAME *structure, void *member) {
+    uintptr_t offset = (uintptr_t)member - (uintptr_t)structure;
+    int low = 0;
+    int high = XSTRUCT_GLUE(XNAME, members) - 1;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (XSTRUCT_GLUE(XNAME, offsets)[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    if (offset - XSTRUCT_GLUE(XNAME, offsets)[low] < XSTRUCT_GLUE(XNAME, sizes)[low]) {
+        return low;
+    }
+    return -1;
+}
+
+// Get a pointer to the Nth member of the struct, or NULL for invalid input.
+// Example:
+//  void *pixel_member(pixel *structure, int index) { ... }
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, member)(XNAME *structure, int index) {
+    if (index < 0 || index >= XSTRUCT_GLUE(XNAME, members)) {
+        return NULL;
+    }
+    return (char *)structure + XSTRUCT_GLUE(XNAME, offsets)[index];
+}
+
+// Get the stringified name of a member, or NULL for invalid input.
+// Example:
+//  const char *pixel_str(pixel *structure, void *member) { ... }
+XDATA_FUNC const char *XSTRUCT_GLUE(XNAME, str)(XNAME *structure, void *member) {
+    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
+    if (i >= 0) {
+        return XENUM_POOL(XSTRUCT_GLUE(XNAME, str), i);
+    }
+    return NULL;
+}
+
+// Get the stringified type of a member, or NULL for invalid input.
+// Example:
+//  const char *pixel_type_str(pixel *structure, void *member) { ... }
+XDATA_FUNC const char *XSTRUCT_GLUE(XNAME, type_str)(XNAME *structure, void *member) {
+    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
+    if (i >= 0) {
+        return XENUM_POOL(XSTRUCT_GLUE(XNAME, type_str), i);
+    }
+    return NULL;
+}
+
+// Call the given function with each member's value until it returns nonzero.
+// Example:
+//  void pixel_iter(pixel *structure, int group, int callback(void *)) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, iter)(XNAME *structure, int callback(void *)) {
+    int i;
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        if (callback((char *)structure + XSTRUCT_GLUE(XNAME, offsets)[i])) {
+            return;
+        }
+    }
+}
+
+// Allocate and return a formatted string containing the member's name and
+// value, or NULL if the member, the format or the allocation is invalid. The
+// format string should contain a "%%s" for the name and a "%%%s" for the
+// value, in that order, and be shorter than XSTRUCT_PRINT_LENGTH once the
+// value's conversion is substituted in. The value is printed according to the
+// member's type tag, falling back to the member's location in memory for
+// other types. Free the string with XDATA_FREE, which is free() by default.
+// Example:
+//  char *pixel_print_member(pixel *structure, void *member, const char *format) { ... }
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print_member)(XNAME *structure, void *member, const char *format) {
+    return XSTRUCT_GLUE(XNAME, print_member_with)(structure, member, format, NULL);
+}
+
+// Same as above, but allocates the string with the given allocator.
+// Example:
+//  char *pixel_print_member_with(pixel *structure, void *member, const char *format,
+//          const xstruct_allocator *allocator) { ... }
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print_member_with)(XNAME *structure, void *member,
+        const char *format, const xstruct_allocator *allocator) {
+    xstruct_formatter formatter;
+    const char *expanded;
+    const char *name;
+    xstruct_type type;
+    char short_buf[XSTRUCT_PRINT_LENGTH];
+    char *formatted;
+    int length;
+    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
+    if (i < 0) {
+        return NULL;
+    }
+    member = (char *)structure + XSTRUCT_GLUE(XNAME, offsets)[i];
+    name = XENUM_POOL(XSTRUCT_GLUE(XNAME, str), i);
+    type = XSTRUCT_GLUE(XNAME, types)[i];
+    xstruct_formatter_init(&formatter, format);
+    expanded = xstruct_formatter_get(&formatter, type);
+    if (expanded == NULL) {
+        return NULL;
+    }
+    // Most members fit in the short buffer, which saves printing them twice.
+    length = xstruct_print_value(NULL, short_buf, sizeof(short_buf), expanded, name, type, member);
+    if (length < 0) {
+        return NULL;
+    }
+    formatted = xstruct_alloc(allocator, (size_t)length + 1);
+    if (formatted == NULL) {
+        return NULL;
+    }
+    if ((size_t)length < sizeof(short_buf)) {
+        memcpy(formatted, short_buf, (size_t)length + 1);
+    } else {
+        xstruct_print_value(NULL, formatted, (size_t)length + 1, expanded, name, type, member);
+    }
+    return formatted;
+}
+
+// Allocate and return a formatted string containing each member's name and
+// value, concatenated by the given separator, or NULL if the format or the
+// allocation is invalid. Free the string with XDATA_FREE.
+// Example:
+//  char *pixel_print(pixel *structure, const char *format, const char *sep) { ... }
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print)(XNAME *structure, const char *format, const char *sep) {
+    return XSTRUCT_GLUE(XNAME, print_with)(structure, format, sep, NULL);
+}
+
+// Same as above, but allocates the string with the given allocator.
+// Example:
+//  char *pixel_print_with(pixel *structure, const char *format, const char *sep,
+//          const xstruct_allocator *allocator) { ... }
+XDATA_FUNC char *XSTRUCT_GLUE(XNAME, print_with)(XNAME *structure, const char *format,
+        const char *sep, const xstruct_allocator *allocator) {
+    size_t size = XSTRUCT_GLUE(XNAME, print_size)(structure, format, sep);
+    char *formatted = size > 0 ? xstruct_alloc(allocator, size) : NULL;
+    if (formatted != NULL) {
+        XSTRUCT_GLUE(XNAME, print_to)(formatted, size, structure, format, sep);
+    }
+    return formatted;
+}
+
+// Write the same string as print() into the buffer without allocating. Like
+// snprintf(), it writes at most cap bytes, always terminates the string if cap
+// is nonzero, and returns the length of the full string, or (size_t)-1 if the
+// format is invalid.
+// Example:
+//  size_t pixel_print_to(char *buf, size_t cap, pixel *structure, const char *format, const char *sep) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, print_to)(char *buf, size_t cap, XNAME *structure,
+        const char *format, const char *sep) {
+    xstruct_formatter formatter;
+    const char *expanded;
+    size_t length = 0;
+    size_t sep_length = strlen(sep);
+    int value_length;
+    int i;
+    xstruct_formatter_init(&formatter, format);
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        if (i > 0) {
+            if (length < cap) {
+                memcpy(buf + length, sep, length + sep_length < cap ?
+                        sep_length : cap - length);
+            }
+            length += sep_length;
+        }
+        expanded = xstruct_formatter_get(&formatter, XSTRUCT_GLUE(XNAME, types)[i]);
+        value_length = expanded == NULL ? -1 :
+                xstruct_print_value(NULL, length < cap ? buf + length : NULL,
+                        length < cap ? cap - length : 0, expanded,
+                        XENUM_POOL(XSTRUCT_GLUE(XNAME, str), i), XSTRUCT_GLUE(XNAME, types)[i],
+                        (char *)structure + XSTRUCT_GLUE(XNAME, offsets)[i]);
+        if (value_length < 0) {
+            if (cap > 0) {
+                buf[0] = '\0';
+            }
+            return (size_t)-1;
+        }
+        length += (size_t)value_length;
+    }
+    if (cap > 0) {
+        buf[length < cap ? length : cap - 1] = '\0';
+    }
+    return length;
+}
+
+// Get the size of the buffer print_to() needs, including the terminator, or
+// zero if the format is invalid.
+// Example:
+//  size_t pixel_print_size(pixel *structure, const char *format, const char *sep) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, print_size)(XNAME *structure, const char *format, const char *sep) {
+    return XSTRUCT_GLUE(XNAME, print_to)(NULL, 0, structure, format, sep) + 1;
+}
+
+// Write the same string as print() to the file without allocating. Returns the
+// number of characters written, or -1 if there was an error.
+// Example:
+//  int pixel_fprint(FILE *file, pixel *structure, const char *format, const char *sep) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, fprint)(FILE *file, XNAME *structure, const char *format, const char *sep) {
+    xstruct_formatter formatter;
+    const char *expanded;
+    size_t length = 0;
+    int value_length;
+    int i;
+    xstruct_formatter_init(&formatter, format);
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        if (i > 0) {
+            length += fputs(sep, file) < 0 ? 0 : strlen(sep);
+        }
+        expanded = xstruct_formatter_get(&formatter, XSTRUCT_GLUE(XNAME, types)[i]);
+        value_length = expanded == NULL ? -1 :
+                xstruct_print_value(file, NULL, 0, expanded,
+                        XENUM_POOL(XSTRUCT_GLUE(XNAME, str), i), XSTRUCT_GLUE(XNAME, types)[i],
+                        (char *)structure + XSTRUCT_GLUE(XNAME, offsets)[i]);
+        if (value_length < 0) {
+            return -1;
+        }
+        length += (size_t)value_length;
+    }
+    return ferror(file) ? -1 : (int)length;
+}
+
+// Write a report of the struct's layout to the file: its size, padding, cache
+// lines and reordered size, then the offset, size, alignment and cache lines
+// of each member, and each gap of padding. Lines are counted from the start
+// of the struct. Returns the number of characters written, or -1 if there was
+// an error.
+// Example:
+//  int pixel_fprint_layout(FILE *file) { ... }
+//  // pixel: size 24, padding 4, cache lines 1, reordered size 24
+//  // offset  size align  lines  member
+//  //      0     4     4      0  int x
+//  //      ...
+//  //     20     4            0  (padding)
+#define X(type, identifier)                                                     \
+    offset = offsetof(XNAME, identifier);                                       \
+    if (offset > end) {                                                         \
+        XSTRUCT_LAYOUT_ROW(end, offset - end, "", "(padding)");                 \
+    }                                                                           \
+    snprintf(align, sizeof(align), "%zu", _Alignof(type));                      \
+    XSTRUCT_LAYOUT_ROW(offset, sizeof(type), align, #type " " #identifier);     \
+    end = offset + sizeof(type);
+#define XSTRUCT_LAYOUT_ROW(start, size, align, name)                            \
+    first = (start) / XSTRUCT_CACHE_LINE;                                       \
+    last = ((start) + (size) - 1) / XSTRUCT_CACHE_LINE;                         \
+    if (first == last) {                                                        \
+        snprintf(lines, sizeof(lines), "%zu", first);                           \
+    } else {                                                                    \
+        snprintf(lines, sizeof(lines), "%zu-%zu", first, last);                 \
+    }                                                                           \
+    written = fprintf(file, "%6zu %5zu %5s %6s  %s\n", (size_t)(start),         \
+            (size_t)(size), align, lines, name);                                \
+    length += written > 0 ? written : 0;
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, fprint_layout)(FILE *file) {
+    size_t offset, end = 0, first, last;
+    char align[24], lines[48];
+    int written, length = 0;
+    written = fprintf(file, "%s: size %zu, padding %zu, cache lines %zu, "
+            "reordered size %zu\noffset  size align  lines  member\n",
+            XENUM_STR(XNAME), sizeof(XNAME), (size_t)XSTRUCT_GLUE(XNAME, padding),
+            (size_t)XSTRUCT_GLUE(XNAME, cache_lines),
+            (size_t)XSTRUCT_GLUE(XNAME, reordered_size));
+    length += written > 0 ? written : 0;
+    #include XSTRUCT_FILE(XNAME)
+    if (sizeof(XNAME) > end) {
+        XSTRUCT_LAYOUT_ROW(end, sizeof(XNAME) - end, "", "(padding)");
+    }
+    return ferror(file) ? -1 : length;
+}
+#undef XSTRUCT_LAYOUT_ROW
+#undef X
+
+// Fill in the schema from the member tables. Called through xenum_once().
+// Example:
+//  static void pixel_schema_init(void) { ... }
+static void XSTRUCT_GLUE(XNAME, schema_init)(void) {
+    xstruct_field *field;
+    int i;
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        field = &XSTRUCT_GLUE(XNAME, schema_fields)[i];
+        field->name = XENUM_POOL(XSTRUCT_GLUE(XNAME, str), i);
+        field->type = XENUM_POOL(XSTRUCT_GLUE(XNAME, type_str), i);
+        field->tag = XSTRUCT_GLUE(XNAME, types)[i];
+        field->offset = XSTRUCT_GLUE(XNAME, offsets)[i];
+        field->size = XSTRUCT_GLUE(XNAME, sizes)[i];
+#if XGROUP
+        field->group = XSTRUCT_GLUE(XNAME, groups)[i];
+#else
+        field->group = -1;
+#endif // XGROUP
+    }
+    XSTRUCT_GLUE(XNAME, schema_table).name = XENUM_STR(XNAME);
+    XSTRUCT_GLUE(XNAME, schema_table).size = sizeof(XNAME);
+    XSTRUCT_GLUE(XNAME, schema_table).align = _Alignof(XNAME);
+    XSTRUCT_GLUE(XNAME, schema_table).count = XSTRUCT_GLUE(XNAME, members);
+    XSTRUCT_GLUE(XNAME, schema_table).fields = XSTRUCT_GLUE(XNAME, schema_fields);
+}
+
+// Get a description of the struct and each of its members, for handing raw
+// arrays of it to other tools. See xstruct_schema_json() to export it.
+// Example:
+//  const xstruct_schema *pixel_schema(void) { ... }
+XDATA_FUNC const xstruct_schema *XSTRUCT_GLUE(XNAME, schema)(void) {
+    xenum_once(&XSTRUCT_GLUE(XNAME, schema_state), XSTRUCT_GLUE(XNAME, schema_init));
+    return &XSTRUCT_GLUE(XNAME, schema_table);
+}
+
+#if XGROUP
+
+// Get the group of a member, or -1 for invalid input.
+// Example:
+//  int pixel_group(pixel *structure, void *member) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, group)(XNAME *structure, void *member) {
+    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
+    if (i >= 0) {
+        return XSTRUCT_GLUE(XNAME, groups)[i];
+    }
+    return -1;
+}
+
+// Check whether the member belongs to the group.
+// Example:
+//  int pixel_is_in_group(pixel *structure, void *member, int group) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, is_in_group)(XNAME *structure, void *member, int group) {
+    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
+    return i >= 0 && XSTRUCT_GLUE(XNAME, groups)[i] == group;
+}
+
+// Merge each group's members into runs of bytes. Members are laid out in
+// order, so consecutive indices are adjacent, apart from padding.
+// Example:
+//  static void pixel_group_range_init(void) { ... }
+static void XSTRUCT_GLUE(XNAME, group_range_init)(void) {
+    const int *offsets = XSTRUCT_GLUE(XNAME, group_offsets);
+    const int *members = XSTRUCT_GLUE(XNAME, group_members);
+    xstruct_range *ranges = XSTRUCT_GLUE(XNAME, group_range_list);
+    int count = 0, slot, i, member;
+    for (slot = 0; slot < XSTRUCT_GLUE(XNAME, group_slots); slot++) {
+        XSTRUCT_GLUE(XNAME, group_range_offsets)[slot] = count;
+        for (i = offsets[slot]; i < offsets[slot + 1]; i++) {
+            member = members[i];
+            if (i > offsets[slot] && members[i - 1] == member - 1) {
+                ranges[count - 1].size = XSTRUCT_GLUE(XNAME, offsets)[member] +
+                        XSTRUCT_GLUE(XNAME, sizes)[member] - ranges[count - 1].offset;
+            } else {
+                ranges[count].offset = XSTRUCT_GLUE(XNAME, offsets)[member];
+                ranges[count].size = XSTRUCT_GLUE(XNAME, sizes)[member];
+                count++;
+            }
+        }
+    }
+    XSTRUCT_GLUE(XNAME, group_range_offsets)[slot] = count;
+}
+
+// Sort the member indices by group, keeping their order within each group.
+// Called through xenum_once().
+// Example:
+//  static void pixel_group_init(void) { ... }
+static void XSTRUCT_GLUE(XNAME, group_init)(void) {
+    int *offsets = XSTRUCT_GLUE(XNAME, group_offsets);
+    int i, slot;
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        offsets[XSTRUCT_GLUE(XNAME, groups)[i] - XSTRUCT_GLUE(XNAME, group_lowest) + 1]++;
+    }
+    for (slot = 1; slot <= XSTRUCT_GLUE(XNAME, group_slots); slot++) {
+        offsets[slot] += offsets[slot - 1];
+    }
+    // Use each group's start as a cursor, which leaves it at the next group's
+    // start, then shift the offsets back into place.
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        slot = XSTRUCT_GLUE(XNAME, groups)[i] - XSTRUCT_GLUE(XNAME, group_lowest);
+        XSTRUCT_GLUE(XNAME, group_members)[offsets[slot]++] = i;
+    }
+    for (slot = XSTRUCT_GLUE(XNAME, group_slots); slot > 0; slot--) {
+        offsets[slot] = offsets[slot - 1];
+    }
+    offsets[0] = 0;
+    XSTRUCT_GLUE(XNAME, group_range_init)();
+}
+
+// Get the indices of the members in the group, in order, and store how many
+// there are in count.
+// Example:
+//  const int *pixel_group_indices(int group, int *count) { ... }
+XDATA_FUNC const int *XSTRUCT_GLUE(XNAME, group_indices)(int group, int *count) {
+    unsigned int slot = (unsigned int)group - (unsigned int)XSTRUCT_GLUE(XNAME, group_lowest);
+    xenum_once(&XSTRUCT_GLUE(XNAME, group_state), XSTRUCT_GLUE(XNAME, group_init));
+    if (slot >= XSTRUCT_GLUE(XNAME, group_slots)) {
+        *count = 0;
+        return XSTRUCT_GLUE(XNAME, group_members);
+    }
+    *count = XSTRUCT_GLUE(XNAME, group_offsets)[slot + 1] -
+            XSTRUCT_GLUE(XNAME, group_offsets)[slot];
+    return XSTRUCT_GLUE(XNAME, group_members) + XSTRUCT_GLUE(XNAME, group_offsets)[slot];
+}
+
+// Call the given function with a pointer to each member until it returns nonzero.
+// Only the group's own members are visited.
+// Example:
+//  void pixel_group_iter(pixel *structure, int group, int callback(void *)) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, group_iter)(XNAME *structure, int group, int callback(void *)) {
+    int i, count;
+    const int *indices = XSTRUCT_GLUE(XNAME, group_indices)(group, &count);
+    for (i = 0; i < count; i++) {
+        if (callback((char *)structure + XSTRUCT_GLUE(XNAME, offsets)[indices[i]])) {
+            return;
+        }
+    }
+}
+
+// Get the group's members merged into runs of bytes, in order, and store how
+// many there are in count. Members next to each other share a run, including
+// any padding between them.
+// Example:
+//  const xstruct_range *pixel_group_ranges(int group, int *count) { ... }
+XDATA_FUNC const xstruct_range *XSTRUCT_GLUE(XNAME, group_ranges)(int group, int *count) {
+    unsigned int slot = (unsigned int)group - (unsigned int)XSTRUCT_GLUE(XNAME, group_lowest);
+    xenum_once(&XSTRUCT_GLUE(XNAME, group_state), XSTRUCT_GLUE(XNAME, group_init));
+    if (slot >= XSTRUCT_GLUE(XNAME, group_slots)) {
+        *count = 0;
+        return XSTRUCT_GLUE(XNAME, group_range_list);
+    }
+    *count = XSTRUCT_GLUE(XNAME, group_range_offsets)[slot + 1] -
+            XSTRUCT_GLUE(XNAME, group_range_offsets)[slot];
+    return XSTRUCT_GLUE(XNAME, group_range_list) +
+            XSTRUCT_GLUE(XNAME, group_range_offsets)[slot];
+}
+
+// Get the number of bytes group_gather() writes per struct: the size of the
+// group's runs, back to back.
+// Example:
+//  size_t pixel_group_size(int group) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, group_size)(int group) {
+    size_t size = 0;
+    int i, count;
+    const xstruct_range *ranges = XSTRUCT_GLUE(XNAME, group_ranges)(group, &count);
+    for (i = 0; i < count; i++) {
+        size += ranges[i].size;
+    }
+    return size;
+}
+
+// Copy the group's members from one struct to another, one memcpy() per run.
+// Example:
+//  void pixel_group_copy(pixel *dst, const pixel *src, int group) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, group_copy)(XNAME *dst, const XNAME *src, int group) {
+    int i, count;
+    const xstruct_range *ranges = XSTRUCT_GLUE(XNAME, group_ranges)(group, &count);
+    for (i = 0; i < count; i++) {
+        memcpy((char *)dst + ranges[i].offset, (const char *)src + ranges[i].offset,
+                ranges[i].size);
+    }
+}
+
+// Copy the group's members out of an array of n structs into a buffer, which
+// needs room for n * pixel_group_size(group) bytes. Each struct's runs are
+// written back to back in host byte order, so the buffer is meant for
+// group_scatter() on the same kind of machine. Returns the number of bytes
+// written.
+// Example:
+//  size_t pixel_group_gather(const pixel *array, size_t n, int group,
+//          unsigned char *out) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, group_gather)(const XNAME *array, size_t n, int group,
+        unsigned char *out) {
+    size_t size = 0, i;
+    int r, count;
+    const xstruct_range *ranges = XSTRUCT_GLUE(XNAME, group_ranges)(group, &count);
+    if (count == 1) {
+        // A single run is the common case, and a fixed stride per struct.
+        for (i = 0; i < n; i++) {
+            memcpy(out + i * ranges[0].size, (const char *)&array[i] + ranges[0].offset,
+                    ranges[0].size);
+        }
+        return n * ranges[0].size;
+    }
+    for (i = 0; i < n; i++) {
+        for (r = 0; r < count; r++) {
+            memcpy(out + size, (const char *)&array[i] + ranges[r].offset, ranges[r].size);
+            size += ranges[r].size;
+        }
+    }
+    return size;
+}
+
+// Copy the group's members from a buffer written by group_gather() back into
+// an array of n structs, leaving their other members alone. Returns the
+// number of bytes read.
+// Example:
+//  size_t pixel_group_scatter(pixel *array, size_t n, int group,
+//          const unsigned char *in) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, group_scatter)(XNAME *array, size_t n, int group,
+        const unsigned char *in) {
+    size_t size = 0, i;
+    int r, count;
+    const xstruct_range *ranges = XSTRUCT_GLUE(XNAME, group_ranges)(group, &count);
+    if (count == 1) {
+        for (i = 0; i < n; i++) {
+            memcpy((char *)&array[i] + ranges[0].offset, in + i * ranges[0].size,
+                    ranges[0].size);
+        }
+        return n * ranges[0].size;
+    }
+    for (i = 0; i < n; i++) {
+        for (r = 0; r < count; r++) {
+            memcpy((char *)&array[i] + ranges[r].offset, in + size, ranges[r].size);
+            size += ranges[r].size;
+        }
+    }
+    return size;
+}
+
+#endif // XGROUP
+
+#if XSOA
+
+// Grow the columns to hold at least the given number of structs. Returns 0 on
+// success, or -1 if the allocation failed or its size would overflow, leaving
+// the columns untouched.
+// Example:
+//  int pixel_soa_reserve(pixel_soa *soa, size_t capacity) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, soa_reserve)(XSTRUCT_GLUE(XNAME, soa) *soa, size_t capacity) {
+    size_t size = 0;
+    char *columns;
+    if (capacity <= soa->capacity) {
+        return 0;
+    }
+    #define X(type, identifier)                                                 \
+        if (capacity > (SIZE_MAX - XSTRUCT_SOA_ALIGN) / sizeof(type) ||         \
+                XSTRUCT_SOA_ROUND(capacity * sizeof(type)) > SIZE_MAX - size) { \
+            return -1;                                                          \
+        }                                                                       \
+        size += XSTRUCT_SOA_ROUND(capacity * sizeof(type));
+    #include XSTRUCT_FILE(XNAME)
+    #undef X
+    columns = xstruct_alloc_aligned(size);
+    if (columns == NULL) {
+        return -1;
+    }
+    size = 0;
+    #define X(type, identifier)                                                 \
+        if (soa->length > 0) {                                                  \
+            memcpy(columns + size, soa->identifier, soa->length * sizeof(type));\
+        }                                                                       \
+        soa->identifier = (type *)(columns + size);                             \
+        size += XSTRUCT_SOA_ROUND(capacity * sizeof(type));
+    #include XSTRUCT_FILE(XNAME)
+    #undef X
+    xstruct_free_aligned(soa->columns);
+    soa->columns = columns;
+    soa->capacity = capacity;
+    return 0;
+}
+
+// Free the columns and reset the struct of arrays to be empty.
+// Example:
+//  void pixel_soa_free(pixel_soa *soa) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_free)(XSTRUCT_GLUE(XNAME, soa) *soa) {
+    xstruct_free_aligned(soa->columns);
+    memset(soa, 0, sizeof(*soa));
+}
 
-// Internal macros.
-#define XSTRUCT_STR_EXPANDED(identifier) #identifier
-#define XSTRUCT_STR(identifier) XSTRUCT_STR_EXPANDED(identifier)
-#define XSTRUCT_GLUE_EXPANDED(prefix, suffix) prefix ## _ ## suffix
-#define XSTRUCT_GLUE(prefix, suffix) XSTRUCT_GLUE_EXPANDED(prefix, suffix)
-#define XSTRUCT_FILE(name) XENUM_STR(struct.name.h)
+// Append a struct to the columns, growing them if needed. Returns 0 on success
+// or -1 if the columns couldn't grow.
+// Example:
+//  int pixel_soa_push(pixel_soa *soa, const pixel *structure) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, soa_push)(XSTRUCT_GLUE(XNAME, soa) *soa, const XNAME *structure) {
+    if (soa->length == soa->capacity && (soa->capacity > SIZE_MAX / 2 ||
+            XSTRUCT_GLUE(XNAME, soa_reserve)(soa,
+                    soa->capacity ? soa->capacity * 2 : XSTRUCT_SOA_ALIGN) < 0)) {
+        return -1;
+    }
+    XSTRUCT_GLUE(XNAME, soa_set)(soa, soa->length++, structure);
+    return 0;
+}
 
-#define XSTRUCT_PRINT_LENGTH 32
+// Gather the Nth struct from the columns.
+// Example:
+//  void pixel_soa_get(const pixel_soa *soa, size_t i, pixel *structure) { ... }
+#define X(type, identifier) structure->identifier = soa->identifier[i];
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_get)(const XSTRUCT_GLUE(XNAME, soa) *soa, size_t i, XNAME *structure) {
+    #include XSTRUCT_FILE(XNAME)
+}
+#undef X
 
-const char *xstruct_format(char *typestr);
+// Scatter a struct into the Nth row of the columns.
+// Example:
+//  void pixel_soa_set(pixel_soa *soa, size_t i, const pixel *structure) { ... }
+#define X(type, identifier) soa->identifier[i] = structure->identifier;
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_set)(XSTRUCT_GLUE(XNAME, soa) *soa, size_t i, const XNAME *structure) {
+    #include XSTRUCT_FILE(XNAME)
+}
+#undef X
 
-#ifdef XDATA_OWNER
-// Everything in this block should only show up in a single compilation unit.
+// Append an array of structs to the columns, one column at a time. Returns 0
+// on success or -1 if the columns couldn't grow.
+// Example:
+//  int pixel_soa_from_array(pixel_soa *soa, const pixel *array, size_t n) { ... }
+#define X(type, identifier)                                                     \
+    for (i = 0; i < n; i++) {                                                   \
+        soa->identifier[soa->length + i] = array[i].identifier;                 \
+    }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, soa_from_array)(XSTRUCT_GLUE(XNAME, soa) *soa, const XNAME *array, size_t n) {
+    size_t i;
+    if (n > SIZE_MAX - soa->length || (soa->length + n > soa->capacity &&
+            XSTRUCT_GLUE(XNAME, soa_reserve)(soa, soa->length + n) < 0)) {
+        return -1;
+    }
+    #include XSTRUCT_FILE(XNAME)
+    soa->length += n;
+    return 0;
+}
+#undef X
 
-// Retrieves the printf format string associated with the given type string.
-#define X(type, identifier)             \
-    if (strcmp(#type, typestr) == 0) {  \
-        return #identifier;             \
+// Copy every row of the columns into an array of structs, one column at a time.
+// Example:
+//  void pixel_soa_to_array(const pixel_soa *soa, pixel *array) { ... }
+#define X(type, identifier)                                                     \
+    for (i = 0; i < soa->length; i++) {                                         \
+        array[i].identifier = soa->identifier[i];                               \
     }
-const char *xstruct_format(char *typestr) {
-    #include "xtypes.h"
-    return "p";
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, soa_to_array)(const XSTRUCT_GLUE(XNAME, soa) *soa, XNAME *array) {
+    size_t i;
+    #include XSTRUCT_FILE(XNAME)
 }
 #undef X
 
-#endif // XDATA_OWNER
+#endif // XSOA
 
-#endif // XSTRUCT_H_
+// Write the struct to the buffer as a record, which must have room for
+// sizeof(pixel_record) bytes. Returns the number of bytes written.
+// Example:
+//  size_t pixel_serialize(const pixel *structure, unsigned char *out) { ... }
+#define X(type, identifier) \
+    XSTRUCT_COPY_LE(record->identifier, &structure->identifier, sizeof(type));
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, serialize)(const XNAME *structure, unsigned char *out) {
+    XSTRUCT_GLUE(XNAME, record) *record = (XSTRUCT_GLUE(XNAME, record) *)out;
+    #include XSTRUCT_FILE(XNAME)
+    return sizeof(XSTRUCT_GLUE(XNAME, record));
+}
+#undef X
 
-// Everything below this point runs once per struct. Refer to struct.pixel.h
-// for the examples in the comments, as well as enum.pixelgroup.h for those
-// that deal with groups.
+// Read the struct back from a record. Returns the number of bytes read.
+// Example:
+//  size_t pixel_deserialize(pixel *structure, const unsigned char *in) { ... }
+#define X(type, identifier) \
+    XSTRUCT_COPY_LE(&structure->identifier, record->identifier, sizeof(type));
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, deserialize)(XNAME *structure, const unsigned char *in) {
+    const XSTRUCT_GLUE(XNAME, record) *record = (const XSTRUCT_GLUE(XNAME, record) *)in;
+    #include XSTRUCT_FILE(XNAME)
+    return sizeof(XSTRUCT_GLUE(XNAME, record));
+}
+#undef X
 
-////////// Static data structure declarations.
+// Write an array of structs as consecutive records. Returns the number of
+// bytes written.
+// Example:
+//  size_t pixel_serialize_array(const pixel *array, size_t n, unsigned char *out) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, serialize_array)(const XNAME *array, size_t n, unsigned char *out) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        out += XSTRUCT_GLUE(XNAME, serialize)(&array[i], out);
+    }
+    return n * sizeof(XSTRUCT_GLUE(XNAME, record));
+}
 
-// Create the struct for this macro.
+// Read an array of structs from consecutive records. Returns the number of
+// bytes read.
 // Example:
-//  typedef struct pixel { int x; int y; color *color; float alpha; }
-#define X(type, identifier) type identifier;
-typedef struct XNAME {
+//  size_t pixel_deserialize_array(pixel *array, size_t n, const unsigned char *in) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, deserialize_array)(XNAME *array, size_t n, const unsigned char *in) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        in += XSTRUCT_GLUE(XNAME, deserialize)(&array[i], in);
+    }
+    return n * sizeof(XSTRUCT_GLUE(XNAME, record));
+}
+
+#if XPACKED
+
+// Copy the struct into its packed form.
+// Example:
+//  void pixel_pack(const pixel *structure, pixel_packed *packed) { ... }
+#define X(type, identifier) packed->identifier = structure->identifier;
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, pack)(const XNAME *structure, XSTRUCT_GLUE(XNAME, packed) *packed) {
     #include XSTRUCT_FILE(XNAME)
-} XNAME;
+}
 #undef X
 
-// Create the enum for this macro's members.
-// enum { pixel_member_x, pixel_member_y, pixel_member_color, pixel_member_alpha, pixel_members };
-#define X(type, identifier) XSTRUCT_GLUE(XSTRUCT_GLUE(XNAME, member), identifier),
-typedef enum {
+// Copy a packed struct back into its aligned form.
+// Example:
+//  void pixel_unpack(const pixel_packed *packed, pixel *structure) { ... }
+#define X(type, identifier) structure->identifier = packed->identifier;
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, unpack)(const XSTRUCT_GLUE(XNAME, packed) *packed, XNAME *structure) {
     #include XSTRUCT_FILE(XNAME)
-    XSTRUCT_GLUE(XNAME, members)
-} XSTRUCT_GLUE(XNAME, enum);
+}
 #undef X
 
-// Holds the string name of each member in an array.
+// Get the address of the Nth member of a packed struct, or NULL if the index
+// is invalid. The address may be misaligned, so read it with memcpy().
 // Example:
-//  char *pixel_strs[4];
-char *XSTRUCT_GLUE(XNAME, strs)[XSTRUCT_GLUE(XNAME, members)];
+//  void *pixel_packed_member(pixel_packed *packed, int index) { ... }
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, packed_member)(XSTRUCT_GLUE(XNAME, packed) *packed, int index) {
+    if (index < 0 || index >= XSTRUCT_GLUE(XNAME, members)) {
+        return NULL;
+    }
+    return (char *)packed + XSTRUCT_GLUE(XNAME, packed_offsets)[index];
+}
+
+#endif // XPACKED
 
-// Holds the string name of each member's type in an array.
+// Find which members differ between two structs, comparing their bytes like
+// equal(), so the padding inside x87 long doubles is ignored. Sets bit N of
+// the mask, counting from the first word's lowest bit, for each changed
+// member N, clears the rest and returns how many changed.
 // Example:
-//  char *pixel_type_strs[4];
-char *XSTRUCT_GLUE(XNAME, type_strs)[XSTRUCT_GLUE(XNAME, members)];
+//  int pixel_diff(const pixel *a, const pixel *b, pixel_mask *mask) { ... }
+#define X(type, identifier)                                                     \
+    if (memcmp(&a->identifier, &b->identifier,                                  \
+            XSTRUCT_VALUE_SIZE(a->identifier)) != 0) {                          \
+        i = XSTRUCT_GLUE(XSTRUCT_GLUE(XNAME, member), identifier);              \
+        mask->words[i / 64] |= (uint64_t)1 << i % 64;                           \
+        count++;                                                                \
+    }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, diff)(const XNAME *a, const XNAME *b, XSTRUCT_GLUE(XNAME, mask) *mask) {
+    int count = 0, i;
+    memset(mask, 0, sizeof(*mask));
+    #include XSTRUCT_FILE(XNAME)
+    return count;
+}
+#undef X
 
-#if XGROUP
+// Write the members of "to" that differ from "from" into the buffer, which
+// must have room for pixel_delta_max bytes: the changed members' bits from
+// diff(), one byte per eight members, then each changed member's bytes in
+// little-endian order, like a record. Returns the number of bytes written.
+// Example:
+//  size_t pixel_delta_encode(const pixel *from, const pixel *to, unsigned char *out) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_encode)(const XNAME *from, const XNAME *to, unsigned char *out) {
+    XSTRUCT_GLUE(XNAME, mask) mask;
+    size_t size = (XSTRUCT_GLUE(XNAME, members) + 7) / 8;
+    uint64_t word;
+    int i, w;
+    memset(out, 0, size);
+    if (XSTRUCT_GLUE(XNAME, diff)(from, to, &mask) == 0) {
+        return size;
+    }
+    for (w = 0; w < XSTRUCT_GLUE(XNAME, mask_words); w++) {
+        for (word = mask.words[w]; word != 0; word &= word - 1) {
+            i = w * 64 + XENUM_CTZ(word);
+            out[i / 8] |= 1 << i % 8;
+            XSTRUCT_COPY_LE(out + size, (const char *)to + XSTRUCT_GLUE(XNAME, offsets)[i],
+                    XSTRUCT_GLUE(XNAME, sizes)[i]);
+            size += XSTRUCT_GLUE(XNAME, sizes)[i];
+        }
+    }
+    return size;
+}
 
-// Holds the group of each member in an array.
+// Apply a delta from delta_encode() to the struct, overwriting only the
+// members it holds. Bits past the last member are ignored. Returns the number
+// of bytes read.
 // Example:
-//  int pixel_groups[4];
-int XENUM_GLUE(XNAME, groups)[XSTRUCT_GLUE(XNAME, members)];
+//  size_t pixel_delta_apply(pixel *structure, const unsigned char *in) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_apply)(XNAME *structure, const unsigned char *in) {
+    size_t size = (XSTRUCT_GLUE(XNAME, members) + 7) / 8;
+    unsigned int byte;
+    int b, i;
+    for (b = 0; b < (XSTRUCT_GLUE(XNAME, members) + 7) / 8; b++) {
+        for (byte = in[b]; byte != 0; byte &= byte - 1) {
+            i = b * 8 + XENUM_CTZ(byte);
+            if (i >= XSTRUCT_GLUE(XNAME, members)) {
+                break;
+            }
+            XSTRUCT_COPY_LE((char *)structure + XSTRUCT_GLUE(XNAME, offsets)[i], in + size,
+                    XSTRUCT_GLUE(XNAME, sizes)[i]);
+            size += XSTRUCT_GLUE(XNAME, sizes)[i];
+        }
+    }
+    return size;
+}
 
-#endif // XGROUP
+// Write deltas for every struct that differs between two arrays of n structs.
+// Each one is the number of unchanged structs skipped since the last, as
+// LEB128, then the struct's delta. Unchanged structs cost nothing, and the
+// buffer needs room for at most n * (XSTRUCT_VARINT_MAX + pixel_delta_max)
+// bytes. Returns the number of bytes written.
+// Example:
+//  size_t pixel_delta_encode_array(const pixel *from, const pixel *to, size_t n,
+//          unsigned char *out) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_encode_array)(const XNAME *from, const XNAME *to, size_t n,
+        unsigned char *out) {
+    size_t size = 0, next = 0, i;
+    for (i = 0; i < n; i++) {
+        if (XSTRUCT_GLUE(XNAME, equal)(&from[i], &to[i])) {
+            continue;
+        }
+        size += xstruct_varint_put(out + size, i - next);
+        size += XSTRUCT_GLUE(XNAME, delta_encode)(&from[i], &to[i], out + size);
+        next = i + 1;
+    }
+    return size;
+}
 
-////////// Function declarations. Refer to their definitions for documentation.
+// Get the size of a delta from delta_encode() by reading its mask.
+static size_t XSTRUCT_GLUE(XNAME, delta_size)(const unsigned char *in) {
+    size_t size = (XSTRUCT_GLUE(XNAME, members) + 7) / 8;
+    unsigned int byte;
+    int b, i;
+    for (b = 0; b < (XSTRUCT_GLUE(XNAME, members) + 7) / 8; b++) {
+        for (byte = in[b]; byte != 0; byte &= byte - 1) {
+            i = b * 8 + XENUM_CTZ(byte);
+            if (i >= XSTRUCT_GLUE(XNAME, members)) {
+                break;
+            }
+            size += XSTRUCT_GLUE(XNAME, sizes)[i];
+        }
+    }
+    return size;
+}
 
-int XSTRUCT_GLUE(XNAME, index)(XNAME *structure, void *member);
-void *XSTRUCT_GLUE(XNAME, member)(XNAME *structure, int index);
-char *XSTRUCT_GLUE(XNAME, str)(XNAME *structure, void *member);
-char *XSTRUCT_GLUE(XNAME, type_str)(XNAME *structure, void *member);
-void XSTRUCT_GLUE(XNAME, iter)(XNAME *structure, int callback(void *));
-char *XSTRUCT_GLUE(XNAME, print_member)(XNAME *structure, void *member, const char *format);
-char *XSTRUCT_GLUE(XNAME, print)(XNAME *structure, const char *format, const char *sep);
+// Apply the deltas from delta_encode_array() in a buffer of the given size to
+// an array of n structs. Returns the number of bytes read, which is less than
+// size if a delta was truncated or pointed past the end of the array.
+// Example:
+//  size_t pixel_delta_apply_array(pixel *array, size_t n, const unsigned char *in,
+//          size_t size) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, delta_apply_array)(XNAME *array, size_t n,
+        const unsigned char *in, size_t size) {
+    size_t used = 0, next = 0, length;
+    uint64_t skip;
+    while (used < size) {
+        length = xstruct_varint_get(in + used, size - used, &skip);
+        if (length == 0 || skip >= n - next ||
+                size - used - length < (XSTRUCT_GLUE(XNAME, members) + 7) / 8 ||
+                size - used - length < XSTRUCT_GLUE(XNAME, delta_size)(in + used + length)) {
+            break;
+        }
+        next += skip;
+        used += length + XSTRUCT_GLUE(XNAME, delta_apply)(&array[next], in + used + length);
+        next++;
+    }
+    return used;
+}
 
-#if XGROUP
-int XSTRUCT_GLUE(XNAME, group)(XNAME *structure, void *member);
-void XSTRUCT_GLUE(XNAME, group_iter)(XNAME *structure, int group, int callback(void *));
-#endif
+// Get the index of the member with the given name, or -1 if there is none.
+// The expected index is checked first, so input in declaration order costs a
+// single comparison per member.
+// Example:
+//  static int pixel_find(const char *name, size_t length, int expected) { ... }
+static int XSTRUCT_GLUE(XNAME, find)(const char *name, size_t length, int expected) {
+    int i;
+    if (expected < XSTRUCT_GLUE(XNAME, members) &&
+            XSTRUCT_GLUE(XNAME, lengths)[expected] == length &&
+            memcmp(XENUM_POOL(XSTRUCT_GLUE(XNAME, str), expected), name, length) == 0) {
+        return expected;
+    }
+    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
+        if (XSTRUCT_GLUE(XNAME, lengths)[i] == length &&
+                memcmp(XENUM_POOL(XSTRUCT_GLUE(XNAME, str), i), name, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-#ifdef XDATA_OWNER
-// Everything in this block should only show up in a single compilation unit
-// for each enum.
+// Parse one string against a pattern split out of a format string.
+// Example:
+//  static int pixel_parse_pattern(const char *s, size_t len, const xstruct_pattern *pattern,
+//          const char *sep, size_t sep_length, pixel *out) { ... }
+static int XSTRUCT_GLUE(XNAME, parse_pattern)(const char *s, size_t len,
+        const xstruct_pattern *pattern, const char *sep, size_t sep_length, XNAME *out) {
+    const char *end = s + len;
+    const char *name, *value, *stop;
+    int parsed = 0;
+    int i = 0;
+    if (len == 0) {
+        return 0;
+    }
+    for (;;) {
+        if ((size_t)(end - s) < pattern->lead_length ||
+                memcmp(s, pattern->lead, pattern->lead_length) != 0) {
+            return -1;
+        }
+        name = s + pattern->lead_length;
+        s = xstruct_find(name, end - name, pattern->mid, pattern->mid_length);
+        if (s == NULL || (i = XSTRUCT_GLUE(XNAME, find)(name, s - name, i)) < 0) {
+            return -1;
+        }
+        // The value ends at the tail, or at the separator if there's no tail.
+        value = s + pattern->mid_length;
+        if (pattern->tail_length > 0) {
+            stop = xstruct_find(value, end - value, pattern->tail, pattern->tail_length);
+        } else {
+            stop = xstruct_find(value, end - value, sep, sep_length);
+            stop = stop && sep_length > 0 ? stop : end;
+        }
+        if (stop == NULL || xstruct_parse_value(value, stop - value,
+                XSTRUCT_GLUE(XNAME, types)[i],
+                (char *)out + XSTRUCT_GLUE(XNAME, offsets)[i]) < 0) {
+            return -1;
+        }
+        parsed++;
+        i++;
+        s = stop + pattern->tail_length;
+        if (s == end) {
+            return parsed;
+        }
+        if (sep_length == 0 || (size_t)(end - s) < sep_length ||
+                memcmp(s, sep, sep_length) != 0) {
+            return -1;
+        }
+        s += sep_length;
+    }
+}
 
-////////// Variable definitions.
+// Parse the first len characters of a string written by print() with the same
+// format and separator, assigning each member it names. Members may appear in
+// any order, and those that don't appear are left untouched, as are string
+// and pointer members. Returns the number of members found, or -1 if the
+// string doesn't match the format or the format is invalid.
+// Example:
+//  int pixel_parse(const char *s, size_t len, const char *format, const char *sep, pixel *out) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, parse)(const char *s, size_t len, const char *format,
+        const char *sep, XNAME *out) {
+    char text[XSTRUCT_PRINT_LENGTH];
+    xstruct_pattern pattern;
+    int text_length = snprintf(text, sizeof(text), format, "s");
+    if (text_length < 0 || (size_t)text_length >= sizeof(text) ||
+            xstruct_pattern_init(&pattern, text) < 0) {
+        return -1;
+    }
+    return XSTRUCT_GLUE(XNAME, parse_pattern)(s, len, &pattern, sep, strlen(sep), out);
+}
+
+// Parse up to max structs from consecutive lines, as parse() would, skipping
+// empty lines. Stops at the first line that doesn't match the format. Returns
+// the number of structs parsed, which is zero if the format is invalid.
+// Example:
+//  size_t pixel_parse_lines(const char *s, size_t len, const char *format,
+//          const char *sep, pixel *out, size_t max) { ... }
+XDATA_FUNC size_t XSTRUCT_GLUE(XNAME, parse_lines)(const char *s, size_t len, const char *format,
+        const char *sep, XNAME *out, size_t max) {
+    char text[XSTRUCT_PRINT_LENGTH];
+    xstruct_pattern pattern;
+    int text_length = snprintf(text, sizeof(text), format, "s");
+    size_t sep_length = strlen(sep);
+    const char *end = s + len;
+    const char *line_end;
+    size_t line_length;
+    size_t parsed = 0;
+    if (text_length < 0 || (size_t)text_length >= sizeof(text) ||
+            xstruct_pattern_init(&pattern, text) < 0) {
+        return 0;
+    }
+    while (s < end && parsed < max) {
+        line_end = memchr(s, '\n', end - s);
+        line_end = line_end ? line_end : end;
+        line_length = line_end - s;
+        if (line_length > 0 && s[line_length - 1] == '\r') {
+            line_length--;
+        }
+        if (line_length > 0) {
+            if (XSTRUCT_GLUE(XNAME, parse_pattern)(s, line_length, &pattern,
+                    sep, sep_length, &out[parsed]) < 0) {
+                break;
+            }
+            parsed++;
+        }
+        s = line_end + 1;
+    }
+    return parsed;
+}
 
-// Create the string array of member names.
+// Hash the struct's members, packed without padding as in a serialized
+// record, so that structs that are equal() always hash the same. The padding
+// inside x87 long doubles is zeroed first.
 // Example:
-//  char *pixel_members[] = { "x", "y", "color", "alpha" };
-#define X(type, identifier) #identifier,
-char *XSTRUCT_GLUE(XNAME, strs)[] = {
+//  uint64_t pixel_hash(const pixel *structure) { ... }
+#define X(type, identifier)                                                     \
+    memset(record.identifier + XSTRUCT_VALUE_SIZE(structure->identifier), 0,    \
+            sizeof(type) - XSTRUCT_VALUE_SIZE(structure->identifier));
+XDATA_FUNC uint64_t XSTRUCT_GLUE(XNAME, hash)(const XNAME *structure) {
+    XSTRUCT_GLUE(XNAME, record) record;
+    XSTRUCT_GLUE(XNAME, serialize)(structure, (unsigned char *)&record);
     #include XSTRUCT_FILE(XNAME)
-};
+    return xstruct_hash_bytes(&record, sizeof(record));
+}
+#undef X
+
+// Check whether two structs hold the same bytes in every member, ignoring any
+// padding between them. Floating point members compare bitwise, and pointers,
+// including strings, by address. Members with padding of their own, like x87
+// long doubles, only compare their value bytes.
+// Example:
+//  int pixel_equal(const pixel *a, const pixel *b) { ... }
+#define X(type, identifier) \
+    memcmp(&a->identifier, &b->identifier, XSTRUCT_VALUE_SIZE(a->identifier)) == 0 &&
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, equal)(const XNAME *a, const XNAME *b) {
+    return
+        #include XSTRUCT_FILE(XNAME)
+        1;
+}
 #undef X
 
-// Create the string array of types.
-// char *pixel_members = { "int", "int", "color *", "float" };
-#define X(type, identifier) #type,
-char *XSTRUCT_GLUE(XNAME, type_strs)[] = {
+// Order two structs member by member, in declaration order, comparing each
+// member by value. Returns a negative, zero or positive number like strcmp(),
+// and zero exactly when the structs are equal().
+// Example:
+//  int pixel_cmp(const pixel *a, const pixel *b) { ... }
+#define X(type, identifier)                                                     \
+    if ((result = xstruct_cmp_value(XSTRUCT_TYPE(((XNAME *)0)->identifier),     \
+            &a->identifier, &b->identifier, sizeof(type))) != 0) {              \
+        return result;                                                          \
+    }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, cmp)(const XNAME *a, const XNAME *b) {
+    int result;
     #include XSTRUCT_FILE(XNAME)
-};
+    return 0;
+}
 #undef X
 
 #if XGROUP
 
-// Create the group array.
+// Same as hash(), but only hashes the members in the group, so that the group
+// can serve as a key.
 // Example:
-//  int pixel_groups[] = { pix_pos, pix_pos, pix_other, pix_other };
-#define X(type, identifier)
-#undef GROUP
-#define GROUP(g) g,
-int XSTRUCT_GLUE(XNAME, groups)[] = {
-    #include XSTRUCT_FILE(XNAME)
-};
-#undef GROUP
-#define GROUP(g)
-#undef X
+//  uint64_t pixel_hash_group(const pixel *structure, int group) { ... }
+XDATA_FUNC uint64_t XSTRUCT_GLUE(XNAME, hash_group)(const XNAME *structure, int group) {
+    unsigned char packed[sizeof(XSTRUCT_GLUE(XNAME, record))];
+    size_t size = 0, value_size;
+    int i, count;
+    const int *indices = XSTRUCT_GLUE(XNAME, group_indices)(group, &count);
+    for (i = 0; i < count; i++) {
+        value_size = XSTRUCT_VALUE_SIZE_OF(XSTRUCT_GLUE(XNAME, types)[indices[i]],
+                XSTRUCT_GLUE(XNAME, sizes)[indices[i]]);
+        XSTRUCT_COPY_LE(packed + size, (const char *)structure +
+                XSTRUCT_GLUE(XNAME, offsets)[indices[i]], value_size);
+        size += value_size;
+    }
+    return xstruct_hash_bytes(packed, size);
+}
+
+// Same as equal(), but only compares the members in the group.
+// Example:
+//  int pixel_equal_group(const pixel *a, const pixel *b, int group) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, equal_group)(const XNAME *a, const XNAME *b, int group) {
+    int i, count;
+    const int *indices = XSTRUCT_GLUE(XNAME, group_indices)(group, &count);
+    for (i = 0; i < count; i++) {
+        size_t offset = XSTRUCT_GLUE(XNAME, offsets)[indices[i]];
+        if (memcmp((const char *)a + offset, (const char *)b + offset,
+                XSTRUCT_VALUE_SIZE_OF(XSTRUCT_GLUE(XNAME, types)[indices[i]],
+                XSTRUCT_GLUE(XNAME, sizes)[indices[i]])) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Same as cmp(), but only compares the members in the group.
+// Example:
+//  int pixel_cmp_group(const pixel *a, const pixel *b, int group) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, cmp_group)(const XNAME *a, const XNAME *b, int group) {
+    int i, count, result;
+    const int *indices = XSTRUCT_GLUE(XNAME, group_indices)(group, &count);
+    for (i = 0; i < count; i++) {
+        size_t offset = XSTRUCT_GLUE(XNAME, offsets)[indices[i]];
+        result = xstruct_cmp_value(XSTRUCT_GLUE(XNAME, types)[indices[i]],
+                (const char *)a + offset, (const char *)b + offset,
+                XSTRUCT_GLUE(XNAME, sizes)[indices[i]]);
+        if (result != 0) {
+            return result;
+        }
+    }
+    return 0;
+}
 
 #endif // XGROUP
 
-////////// Function definitions.
+// Get the tag stored for a key: the low bits of its hash, with the top bit set
+// so that it's never zero. The low bits also pick the key's first slot.
+#define XSTRUCT_MAP_TAG(key) ((uint32_t)XSTRUCT_GLUE(XNAME, hash)(key) | 0x80000000u)
+
+// Find the slot holding the key, or the empty slot where it would go.
+static size_t XSTRUCT_GLUE(XNAME, map_find)(const XSTRUCT_GLUE(XNAME, map) *map,
+        const XNAME *key, uint32_t tag) {
+    size_t mask = map->capacity - 1;
+    size_t i = tag & mask;
+    while (map->tags[i] != 0) {
+        if (map->tags[i] == tag && XSTRUCT_GLUE(XNAME, equal)(&map->keys[i], key)) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
 
-// Get the index of the member, or -1 for invalid input.
+// Set up an empty map whose values are value_size bytes each. Nothing is
+// allocated until the first key is added.
 // Example:
-//  void *pixel_index(pixel *structure, int index) { ... }
-#define X(type, identifier)                 \
-    if (member == &structure->identifier) { \
-        return i;                           \
-    }                                       \
-    i++;
-int XSTRUCT_GLUE(XNAME, index)(XNAME *structure, void *member) {
-    int i = 0;
-    #include XSTRUCT_FILE(XNAME)
-    return -1;
+//  void pixel_map_init(pixel_map *map, size_t value_size) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_init)(XSTRUCT_GLUE(XNAME, map) *map, size_t value_size) {
+    memset(map, 0, sizeof(*map));
+    map->value_size = value_size;
 }
-#undef X
 
-// Get a pointer to the Nth member of the struct.
+// Make room for at least count keys without growing again, moving the
+// existing keys over. Returns 0 on success, or -1 if the allocation failed or
+// its size would overflow, leaving the map untouched.
 // Example:
-//  void *pixel_member(pixel *structure, int index) { ... }
-#define X(type, identifier)             \
-    if (i == index) {                   \
-        return &structure->identifier;  \
-    }                                   \
-    i++;
-void *XSTRUCT_GLUE(XNAME, member)(XNAME *structure, int index) {
-    int i = 0;
-    #include XSTRUCT_FILE(XNAME)
-    return NULL;
+//  int pixel_map_reserve(pixel_map *map, size_t count) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, map_reserve)(XSTRUCT_GLUE(XNAME, map) *map, size_t count) {
+    XSTRUCT_GLUE(XNAME, map) old = *map;
+    size_t capacity = XSTRUCT_MAP_MIN;
+    size_t tags_size, keys_size, size, mask, i, j;
+    char *block;
+    while (capacity / 4 * 3 < count) {
+        if (capacity > SIZE_MAX / 2) {
+            return -1;
+        }
+        capacity *= 2;
+    }
+    if (capacity <= map->capacity) {
+        return 0;
+    }
+    // Keeping each part under a quarter of SIZE_MAX keeps their rounded sum
+    // from overflowing too.
+    if (capacity > SIZE_MAX / 4 / sizeof(uint32_t) ||
+            capacity > SIZE_MAX / 4 / sizeof(XNAME) ||
+            (map->value_size > 0 && capacity > SIZE_MAX / 4 / map->value_size)) {
+        return -1;
+    }
+    tags_size = XSTRUCT_SOA_ROUND(capacity * sizeof(uint32_t));
+    keys_size = XSTRUCT_SOA_ROUND(capacity * sizeof(XNAME));
+    size = tags_size + keys_size + XSTRUCT_SOA_ROUND(capacity * map->value_size);
+    block = xstruct_alloc_aligned(size);
+    if (block == NULL) {
+        return -1;
+    }
+    memset(block, 0, size);
+    map->tags = (uint32_t *)block;
+    map->keys = (XNAME *)(block + tags_size);
+    map->values = (unsigned char *)block + tags_size + keys_size;
+    map->capacity = capacity;
+    mask = capacity - 1;
+    for (i = 0; i < old.capacity; i++) {
+        if (old.tags[i] == 0) {
+            continue;
+        }
+        for (j = old.tags[i] & mask; map->tags[j] != 0; j = (j + 1) & mask) {
+        }
+        map->tags[j] = old.tags[i];
+        map->keys[j] = old.keys[i];
+        memcpy(map->values + j * map->value_size,
+                old.values + i * map->value_size, map->value_size);
+    }
+    xstruct_free_aligned(old.tags);
+    return 0;
 }
-#undef X
 
-// Get the stringified name of a member, or NULL for invalid input.
+// Free the map's storage and reset it to be empty, keeping its value size.
 // Example:
-//  char *pixel_str(pixel *structure, void *member) { ... }
-char *XSTRUCT_GLUE(XNAME, str)(XNAME *structure, void *member) {
-    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
-    if (i >= 0) {
-        return XSTRUCT_GLUE(XNAME, strs)[i];
+//  void pixel_map_free(pixel_map *map) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_free)(XSTRUCT_GLUE(XNAME, map) *map) {
+    xstruct_free_aligned(map->tags);
+    XSTRUCT_GLUE(XNAME, map_init)(map, map->value_size);
+}
+
+// Get a pointer to the key's value, or NULL if it isn't in the map. Keys are
+// matched with pixel_equal().
+// Example:
+//  void *pixel_map_get(const pixel_map *map, const pixel *key) { ... }
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, map_get)(const XSTRUCT_GLUE(XNAME, map) *map, const XNAME *key) {
+    size_t i;
+    if (map->length == 0) {
+        return NULL;
     }
-    return NULL;
+    i = XSTRUCT_GLUE(XNAME, map_find)(map, key, XSTRUCT_MAP_TAG(key));
+    if (map->tags[i] == 0) {
+        return NULL;
+    }
+    return map->values + i * map->value_size;
 }
 
-// Get the stringified type of a member, or NULL for invalid input.
+// Get a pointer to the key's value, adding the key with a zeroed value if it
+// isn't in the map yet. The pointer is only valid until the next key is added
+// or removed. Returns NULL if the map needed to grow and couldn't.
 // Example:
-//  char *pixel_type_str(pixel *structure, void *member) { ... }
-char *XSTRUCT_GLUE(XNAME, type_str)(XNAME *structure, void *member) {
-    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
-    if (i >= 0) {
-        return XSTRUCT_GLUE(XNAME, type_strs)[i];
+//  void *pixel_map_put(pixel_map *map, const pixel *key) { ... }
+XDATA_FUNC void *XSTRUCT_GLUE(XNAME, map_put)(XSTRUCT_GLUE(XNAME, map) *map, const XNAME *key) {
+    uint32_t tag = XSTRUCT_MAP_TAG(key);
+    size_t i;
+    if (map->capacity / 4 * 3 <= map->length &&
+            XSTRUCT_GLUE(XNAME, map_reserve)(map, map->length + 1) < 0) {
+        return NULL;
     }
-    return NULL;
+    i = XSTRUCT_GLUE(XNAME, map_find)(map, key, tag);
+    if (map->tags[i] == 0) {
+        map->tags[i] = tag;
+        map->keys[i] = *key;
+        map->length++;
+    }
+    return map->values + i * map->value_size;
 }
 
-// Call the given function with each member's value until it returns nonzero.
+// Remove the key from the map. Returns 1 if it was there, or 0 otherwise. The
+// keys after it in its run shift back, so lookups never pass tombstones.
 // Example:
-//  void pixel_iter(pixel *structure, int group, int callback(void *)) { ... }
-void XSTRUCT_GLUE(XNAME, iter)(XNAME *structure, int callback(void *)) {
-    int i;
-    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
-        if (callback(XSTRUCT_GLUE(XNAME, member)(structure, i))) {
-            return;
+//  int pixel_map_remove(pixel_map *map, const pixel *key) { ... }
+XDATA_FUNC int XSTRUCT_GLUE(XNAME, map_remove)(XSTRUCT_GLUE(XNAME, map) *map, const XNAME *key) {
+    size_t mask = map->capacity - 1;
+    size_t i, j, home;
+    if (map->length == 0) {
+        return 0;
+    }
+    i = XSTRUCT_GLUE(XNAME, map_find)(map, key, XSTRUCT_MAP_TAG(key));
+    if (map->tags[i] == 0) {
+        return 0;
+    }
+    for (j = (i + 1) & mask; map->tags[j] != 0; j = (j + 1) & mask) {
+        // Keys whose first slot lies cyclically in (i, j] must stay put.
+        home = map->tags[j] & mask;
+        if (((j - home) & mask) < ((j - i) & mask)) {
+            continue;
         }
+        map->tags[i] = map->tags[j];
+        map->keys[i] = map->keys[j];
+        memcpy(map->values + i * map->value_size,
+                map->values + j * map->value_size, map->value_size);
+        i = j;
     }
+    map->tags[i] = 0;
+    memset(map->values + i * map->value_size, 0, map->value_size);
+    map->length--;
+    return 1;
 }
 
-// Allocate and return a formatted string containing the member's name and
-// value. The format string should contain a "%%s" for the name and a "%%%s"
-// for the value, in that order. XData tries to guess how to print the value
-// according to the type but falls back to the member's location in memory.
+// Remove every key from the map, keeping its storage.
 // Example:
-//  char *pixel_print_member(pixel *structure, void *member, const char *format) { ... }
-#define X(type, identifier)                                                     \
-    if (strcmp(#type, member_type) XSTRUCT_CMP 0) {                             \
-        int formatted_length = snprintf(formatted,                              \
-                    formatter_length + XSTRUCT_PRINT_LENGTH, formatter,         \
-                    member_name, XSTRUCT_DEREF(type*)member);                   \
-        if (formatted_length >= formatter_length + XSTRUCT_PRINT_LENGTH) {      \
-            formatted = realloc(formatted, formatted_length + 1);               \
-            snprintf(formatted, formatted_length + 1, formatter, member_name,   \
-                        XSTRUCT_DEREF(type*)member);                            \
-        }                                                                       \
-        return formatted;                                                       \
-    }
-char *XSTRUCT_GLUE(XNAME, print_member)(XNAME *structure, void *member, const char *format) {
-    char *member_name = XSTRUCT_GLUE(XNAME, str)(structure, member);
-    char *member_type = XSTRUCT_GLUE(XNAME, type_str)(structure, member);
-    const char *member_format = xstruct_format(member_type);
-    char *formatter = malloc(XSTRUCT_PRINT_LENGTH);
-    int formatter_length = snprintf(formatter, XSTRUCT_PRINT_LENGTH, format, member_format);
-    if (formatter_length >= XSTRUCT_PRINT_LENGTH) {
-        formatter = realloc(formatter, formatter_length + 1);
-        snprintf(formatter, formatter_length + 1, format, member_format);
-    }
-    char *formatted = malloc(formatter_length + XSTRUCT_PRINT_LENGTH);
-    #define XSTRUCT_CMP ==
-    #define XSTRUCT_DEREF *
-    #include "xtypes.h"
-    #undef XSTRUCT_CMP
-    #undef XSTRUCT_DEREF
-    #define XSTRUCT_CMP !=
-    #define XSTRUCT_DEREF
-    X(void, )
-    #undef XSTRUCT_CMP
-    #undef XSTRUCT_DEREF
-    return NULL;
+//  void pixel_map_clear(pixel_map *map) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_clear)(XSTRUCT_GLUE(XNAME, map) *map) {
+    if (map->capacity > 0) {
+        memset(map->tags, 0, map->capacity * sizeof(uint32_t));
+        memset(map->values, 0, map->capacity * map->value_size);
+    }
+    map->length = 0;
 }
-#undef X
 
-// Allocate and return a formatted string containing each member's name and
-// value, concatenated by the given separator.
+// Call the function with each key in the map and a pointer to its value, in
+// no particular order, until it returns nonzero. Don't add or remove keys
+// from the callback.
 // Example:
-//  char *pixel_print(pixel *structure, const char *format, const char *sep) { ... }
-char *XSTRUCT_GLUE(XNAME, print)(XNAME *structure, const char *format, const char *sep) {
-    int i;
-    int n_members = XSTRUCT_GLUE(XNAME, members);
-    int formatted_size = XSTRUCT_PRINT_LENGTH * n_members;
-    char *member;
-    char *formatted = malloc(formatted_size);
-    formatted[0] = '\0';
-    for (i = 0; i < n_members; i++) {
-        member = XSTRUCT_GLUE(XNAME, print_member)(structure,
-                XSTRUCT_GLUE(XNAME, member)(structure, i), format);
-        if (strlen(formatted) + strlen(member) > formatted_size) {
-            formatted_size = strlen(formatted) + strlen(member) + strlen(sep) + 1;
-            formatted = realloc(formatted, formatted_size);
-        }
-        strcat(formatted, member);
-        if (i != n_members - 1) {
-            strcat(formatted, sep);
-        }
-        free(member);
+//  void pixel_map_iter(pixel_map *map, int callback(const pixel *, void *)) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, map_iter)(XSTRUCT_GLUE(XNAME, map) *map,
+        int callback(const XNAME *, void *)) {
+    size_t i;
+    for (i = 0; i < map->capacity; i++) {
+        if (map->tags[i] != 0 && callback(&map->keys[i],
+                map->values + i * map->value_size)) {
+            return;
+        }
     }
-    return formatted;
 }
 
-#if XGROUP
+#undef XSTRUCT_MAP_TAG
 
-// Get the group of a member, or -1 for invalid input.
+// Publish a new value of the struct to readers. Only one thread may store
+// into a shared struct, but it never waits for readers.
 // Example:
-//  int pixel_group(pixel *structure, void *member) { ... }
-int XSTRUCT_GLUE(XNAME, group)(XNAME *structure, void *member) {
-    int i = XSTRUCT_GLUE(XNAME, index)(structure, member);
-    if (i >= 0) {
-        return XSTRUCT_GLUE(XNAME, groups)[i];
-    }
-    return -1;
+//  void pixel_shared_store(pixel_shared *shared, const pixel *structure) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, shared_store)(XSTRUCT_GLUE(XNAME, shared) *shared,
+        const XNAME *structure) {
+    xstruct_seqlock_write(&shared->sequence, shared->words, structure, sizeof(XNAME));
 }
 
-// Call the given function with a pointer to each member until it returns nonzero.
+// Copy the latest value of the struct out, without taking a lock. The copy is
+// retried if a store overlapped it, so it's never torn.
 // Example:
-//  void pixel_group_iter(pixel *structure, int group, int callback(void *)) { ... }
-void XSTRUCT_GLUE(XNAME, group_iter)(XNAME *structure, int group, int callback(void *)) {
-    int i;
-    for (i = 0; i < XSTRUCT_GLUE(XNAME, members); i++) {
-        if (XSTRUCT_GLUE(XNAME, groups)[i] == group) {
-            if (callback(XSTRUCT_GLUE(XNAME, member)(structure, i))) {
-                return;
-            }
-        }
+//  void pixel_shared_load(const pixel_shared *shared, pixel *structure) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, shared_load)(const XSTRUCT_GLUE(XNAME, shared) *shared,
+        XNAME *structure) {
+    static const xstruct_range whole = { 0, sizeof(XNAME) };
+    uintptr_t copy[XSTRUCT_GLUE(XNAME, shared_words)];
+    xstruct_seqlock_read(&shared->sequence, shared->words, copy, structure, &whole, 1);
+}
+
+#if XGROUP
+
+// Copy only the members in the group out, like shared_load(), and leave the
+// rest of the struct alone. Only the words under the group's runs are read.
+// Example:
+//  void pixel_shared_load_group(const pixel_shared *shared, pixel *structure, int group) { ... }
+XDATA_FUNC void XSTRUCT_GLUE(XNAME, shared_load_group)(const XSTRUCT_GLUE(XNAME, shared) *shared,
+        XNAME *structure, int group) {
+    uintptr_t copy[XSTRUCT_GLUE(XNAME, shared_words)];
+    int count;
+    const xstruct_range *ranges = XSTRUCT_GLUE(XNAME, group_ranges)(group, &count);
+    if (count > 0) {
+        xstruct_seqlock_read(&shared->sequence, shared->words, copy, structure, ranges, count);
     }
 }
 
@@ -343,5 +2745,18 @@ void XSTRUCT_GLUE(XNAME, group_iter)(XNAME *structure, int group, int callback(v
 #define GROUP(g)
 #endif // XGROUP
 
+#ifdef XPACKED
+#undef XPACKED
+#endif // XPACKED
+
+#ifdef XSOA
+#undef XSOA
+#endif // XSOA
+
+#ifdef XLIST
+#undef XLIST
+#endif // XLIST
+#undef XSTRUCT_FILE
+
 #undef XSTRUCT_H_NESTED_
 #endif // XSTRUCT_H_NESTED_
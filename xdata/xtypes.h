@@ -1 +1,4 @@
 #include "types._builtin.h"
+
+// Every type xstruct.h knows how to print. Append your own lists here.
+#define XTYPES(T) XTYPES_BUILTIN(T)